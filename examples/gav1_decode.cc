@@ -47,6 +47,10 @@ struct Options {
   int threads = 1;
   bool frame_parallel = false;
   bool output_all_layers = false;
+  bool key_frames_only = false;
+  int preview_scale_log2 = 0;
+  bool shared_thread_pool = false;
+  bool parse_ahead = false;
   int operating_point = 0;
   int limit = 0;
   int skip = 0;
@@ -80,6 +84,17 @@ void PrintHelp(FILE* const fout) {
   fprintf(fout, "  --raw (Default true).\n");
   fprintf(fout, "  -v logging verbosity, can be used multiple times.\n");
   fprintf(fout, "  --all_layers.\n");
+  fprintf(fout, "  --key_frames_only Decode and output only the key frames.\n");
+  fprintf(fout,
+          "  --shared_thread_pool Use the thread pool shared by all the"
+          " decoders.\n");
+  fprintf(fout,
+          "  --parse_ahead Parse the next frame of a temporal unit while the"
+          " current one is reconstructed.\n");
+  fprintf(fout,
+          "  --preview_scale_log2 <integer between 0 and 2> (Default 0).\n"
+          "   Approximate preview decoding with output downscaled by"
+          " 2^value.\n");
   fprintf(fout,
           "  --operating_point <integer between 0 and 31> (Default 0).\n");
   fprintf(fout,
@@ -142,6 +157,20 @@ void ParseOptions(int argc, char* argv[], Options* const options) {
       options->frame_parallel = true;
     } else if (strcmp(argv[i], "--all_layers") == 0) {
       options->output_all_layers = true;
+    } else if (strcmp(argv[i], "--key_frames_only") == 0) {
+      options->key_frames_only = true;
+    } else if (strcmp(argv[i], "--shared_thread_pool") == 0) {
+      options->shared_thread_pool = true;
+    } else if (strcmp(argv[i], "--parse_ahead") == 0) {
+      options->parse_ahead = true;
+    } else if (strcmp(argv[i], "--preview_scale_log2") == 0) {
+      if (++i >= argc || !absl::SimpleAtoi(argv[i], &value) || value < 0 ||
+          value > 2) {
+        fprintf(stderr, "Missing/Invalid value for --preview_scale_log2.\n");
+        PrintHelp(stderr);
+        exit(EXIT_FAILURE);
+      }
+      options->preview_scale_log2 = value;
     } else if (strcmp(argv[i], "--operating_point") == 0) {
       if (++i >= argc || !absl::SimpleAtoi(argv[i], &value) || value < 0 ||
           value >= 32) {
@@ -281,6 +310,10 @@ int main(int argc, char* argv[]) {
   settings.threads = options.threads;
   settings.frame_parallel = options.frame_parallel;
   settings.output_all_layers = options.output_all_layers;
+  settings.key_frames_only = options.key_frames_only;
+  settings.preview_scale_log2 = options.preview_scale_log2;
+  settings.shared_thread_pool = options.shared_thread_pool;
+  settings.parse_ahead = options.parse_ahead;
   settings.operating_point = options.operating_point;
   settings.blocking_dequeue = true;
   settings.callback_private_data = &input_buffers;
@@ -14,12 +14,17 @@
 
 #include "src/buffer_pool.h"
 
+#include <algorithm>
 #include <cassert>
+#include <climits>
 #include <cstring>
+#include <functional>
+#include <utility>
 
 #include "src/utils/common.h"
 #include "src/utils/constants.h"
 #include "src/utils/logging.h"
+#include "src/utils/threadpool.h"
 
 namespace libgav1 {
 
@@ -91,10 +96,12 @@ void RefCountedBuffer::SetGlobalMotions(
   }
 }
 
-void RefCountedBuffer::SetFrameContext(const SymbolDecoderContext& context) {
-  frame_context_ = context;
-  frame_context_.ResetIntraFrameYModeCdf();
-  frame_context_.ResetCounters();
+void RefCountedBuffer::SetFrameContext(
+    std::unique_ptr<SymbolDecoderContext> context) {
+  assert(context != nullptr);
+  context->ResetIntraFrameYModeCdf();
+  context->ResetCounters();
+  frame_context_ = std::move(context);
 }
 
 void RefCountedBuffer::GetSegmentationParameters(
@@ -109,6 +116,70 @@ void RefCountedBuffer::SetSegmentationParameters(
 
 void RefCountedBuffer::SetBufferPool(BufferPool* pool) { pool_ = pool; }
 
+bool RefCountedBuffer::RunPendingJob(std::unique_lock<std::mutex>* const lock) {
+  // The job must be taken while |mutex_| is held. Once the frame clears
+  // |decoding_thread_pool_|, the pool may be reused to decode a newer frame,
+  // whose jobs could wait on the frame of the calling thread.
+  if (decoding_thread_pool_ == nullptr) return false;
+  std::function<void()> job;
+  if (!decoding_thread_pool_->TakePendingClosure(&job)) return false;
+  lock->unlock();
+  job();
+  lock->lock();
+  return true;
+}
+
+int RefCountedBuffer::WaitUntilSlow(int progress_row) {
+  // The rows of the reference frames are usually produced shortly after they
+  // are needed. So spin for a little while before doing anything more
+  // expensive.
+  constexpr int kNumSpins = 64;
+  int current_row;
+  for (int i = 0; i < kNumSpins; ++i) {
+    current_row = progress_row_.load(std::memory_order_acquire);
+    if (current_row >= progress_row) return current_row;
+    if (abort_.load(std::memory_order_relaxed)) return current_row;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    current_row = progress_row_.load(std::memory_order_acquire);
+    if (current_row >= progress_row || abort_) break;
+    if (RunPendingJob(&lock)) continue;
+    ProgressWaiter waiter(progress_row);
+    waiter.next = progress_waiters_;
+    progress_waiters_ = &waiter;
+    if (progress_row < min_progress_waiter_row_.load()) {
+      min_progress_waiter_row_.store(progress_row);
+    }
+    // SetProgress() stores |progress_row_| and then loads
+    // |min_progress_waiter_row_|. Here the order is reversed. Since all of
+    // these accesses are sequentially consistent, either SetProgress() sees
+    // |waiter| or the load below sees the new |progress_row_|.
+    if (progress_row_.load() >= progress_row) {
+      WakeProgressWaiters(progress_row_.load());
+    }
+    while (waiter.waiting) waiter.condvar.wait(lock);
+  }
+  return current_row;
+}
+
+void RefCountedBuffer::WakeProgressWaiters(int progress_row) {
+  ProgressWaiter** link = &progress_waiters_;
+  int min_row = INT_MAX;
+  while (*link != nullptr) {
+    ProgressWaiter* const waiter = *link;
+    if (waiter->row <= progress_row) {
+      *link = waiter->next;
+      waiter->waiting = false;
+      waiter->condvar.notify_one();
+    } else {
+      min_row = std::min(min_row, waiter->row);
+      link = &waiter->next;
+    }
+  }
+  min_progress_waiter_row_.store(min_row);
+}
+
 void RefCountedBuffer::ReturnToBufferPool(RefCountedBuffer* ptr) {
   ptr->pool_->ReturnUnusedBuffer(ptr);
 }
@@ -117,7 +188,9 @@ BufferPool::BufferPool(
     FrameBufferSizeChangedCallback on_frame_buffer_size_changed,
     GetFrameBufferCallback get_frame_buffer,
     ReleaseFrameBufferCallback release_frame_buffer,
-    void* callback_private_data) {
+    void* callback_private_data, bool interleave_numa_nodes,
+    bool use_huge_pages)
+    : internal_frame_buffers_(interleave_numa_nodes, use_huge_pages) {
   if (get_frame_buffer != nullptr) {
     // on_frame_buffer_size_changed may be null.
     assert(release_frame_buffer != nullptr);
@@ -18,11 +18,13 @@
 #define LIBGAV1_SRC_BUFFER_POOL_H_
 
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <condition_variable>  // NOLINT (unapproved c++11 header)
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <mutex>  // NOLINT (unapproved c++11 header)
 
 #include "src/dsp/common.h"
@@ -41,6 +43,8 @@
 
 namespace libgav1 {
 
+class ThreadPool;
+
 class BufferPool;
 
 enum FrameState : uint8_t {
@@ -145,11 +149,17 @@ class RefCountedBuffer {
       const std::array<GlobalMotion, kNumReferenceFrameTypes>& global_motions);
 
   // Returns the saved CDF tables.
-  const SymbolDecoderContext& FrameContext() const { return frame_context_; }
-  // Saves the CDF tables. The intra_frame_y_mode_cdf table is reset to the
-  // default. The last entry in each table, representing the symbol count for
-  // that context, is set to 0.
-  void SetFrameContext(const SymbolDecoderContext& context);
+  const SymbolDecoderContextPtr& FrameContext() const { return frame_context_; }
+  // Saves the CDF tables, taking ownership of |context|. The
+  // intra_frame_y_mode_cdf table is reset to the default. The last entry in
+  // each table, representing the symbol count for that context, is set to 0.
+  void SetFrameContext(std::unique_ptr<SymbolDecoderContext> context);
+  // Saves the CDF tables by sharing |context|, without copying it. |context|
+  // must already be in the state established by SetFrameContext(), e.g., it is
+  // the saved CDF tables of another frame or the default CDF tables.
+  void ShareFrameContext(const SymbolDecoderContextPtr& context) {
+    frame_context_ = context;
+  }
 
   const std::array<int8_t, kNumReferenceFrameTypes>& loop_filter_ref_deltas()
       const {
@@ -187,11 +197,11 @@ class RefCountedBuffer {
   void Abort() {
     {
       std::lock_guard<std::mutex> lock(mutex_);
-      abort_ = true;
+      abort_.store(true, std::memory_order_relaxed);
+      WakeProgressWaiters(INT_MAX);
     }
     parsed_condvar_.notify_all();
     decoded_condvar_.notify_all();
-    progress_row_condvar_.notify_all();
   }
 
   void SetFrameState(FrameState frame_state) {
@@ -203,19 +213,39 @@ class RefCountedBuffer {
       parsed_condvar_.notify_all();
     } else if (frame_state == kFrameStateDecoded) {
       decoded_condvar_.notify_all();
-      progress_row_condvar_.notify_all();
+      // Once the frame is decoded, all of its rows are available.
+      SetProgress(INT_MAX);
     }
   }
 
-  // Sets the progress of this frame to |progress_row| and notifies any threads
-  // that may be waiting on rows <= |progress_row|.
+  // Sets the progress of this frame to |progress_row| and wakes up the threads
+  // that are waiting on rows <= |progress_row|. The threads waiting on rows
+  // that are still not available are not woken up. |mutex_| is only taken
+  // when there is at least one such thread to wake up.
   void SetProgress(int progress_row) {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      if (progress_row_ >= progress_row) return;
-      progress_row_ = progress_row;
-    }
-    progress_row_condvar_.notify_all();
+    int current_row = progress_row_.load(std::memory_order_relaxed);
+    do {
+      if (current_row >= progress_row) return;
+    } while (!progress_row_.compare_exchange_weak(current_row, progress_row));
+    // This load must not be reordered with the store above. See
+    // WaitUntilSlow() for the other half of this handshake.
+    if (progress_row < min_progress_waiter_row_.load()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    WakeProgressWaiters(progress_row);
+  }
+
+  // Sets the thread pool that runs the tile jobs of this frame in frame
+  // parallel mode, or clears it (if |thread_pool| is nullptr). While it is set,
+  // the threads that wait on this frame run the pending jobs of |thread_pool|
+  // instead of blocking. This moves the threads of frames that are stalled on
+  // a reference frame to the decoding of that reference frame. The jobs of a
+  // frame only wait on older frames, so this cannot deadlock.
+  //
+  // The frame must clear the thread pool once it no longer schedules jobs on
+  // it.
+  void SetDecodingThreadPool(ThreadPool* thread_pool) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    decoding_thread_pool_ = thread_pool;
   }
 
   void MarkFrameAsStarted() {
@@ -233,7 +263,7 @@ class RefCountedBuffer {
   bool WaitUntilParsed() {
     std::unique_lock<std::mutex> lock(mutex_);
     while (frame_state_ < kFrameStateParsed && !abort_) {
-      parsed_condvar_.wait(lock);
+      if (!RunPendingJob(&lock)) parsed_condvar_.wait(lock);
     }
     return !abort_;
   }
@@ -246,29 +276,27 @@ class RefCountedBuffer {
   // Typical usage of |progress_row_cache| is as follows:
   //  * Initialize |*progress_row_cache| to INT_MIN.
   //  * Call WaitUntil only if |*progress_row_cache| < |progress_row|.
+  //
+  // Once the frame reaches kFrameStateDecoded, |*progress_row_cache| is set to
+  // INT_MAX.
   bool WaitUntil(int progress_row, int* progress_row_cache) {
     // If |progress_row| is negative, it means that the wait is on the top
     // border to be available. The top border will be available when row 0 has
     // been decoded. So we can simply wait on row 0 instead.
     progress_row = std::max(progress_row, 0);
-    std::unique_lock<std::mutex> lock(mutex_);
-    while (progress_row_ < progress_row && frame_state_ != kFrameStateDecoded &&
-           !abort_) {
-      progress_row_condvar_.wait(lock);
+    int current_row = progress_row_.load(std::memory_order_acquire);
+    if (current_row < progress_row) {
+      current_row = WaitUntilSlow(progress_row);
     }
-    // Once |frame_state_| reaches kFrameStateDecoded, |progress_row_| may no
-    // longer be updated. So we set |*progress_row_cache| to INT_MAX in that
-    // case.
-    *progress_row_cache =
-        (frame_state_ != kFrameStateDecoded) ? progress_row_ : INT_MAX;
-    return !abort_;
+    *progress_row_cache = current_row;
+    return !abort_.load(std::memory_order_relaxed);
   }
 
   // Waits until the entire frame has been decoded.
   bool WaitUntilDecoded() {
     std::unique_lock<std::mutex> lock(mutex_);
     while (frame_state_ != kFrameStateDecoded && !abort_) {
-      decoded_condvar_.wait(lock);
+      if (!RunPendingJob(&lock)) decoded_condvar_.wait(lock);
     }
     return !abort_;
   }
@@ -282,6 +310,31 @@ class RefCountedBuffer {
   void SetBufferPool(BufferPool* pool);
   static void ReturnToBufferPool(RefCountedBuffer* ptr);
 
+  // Runs one pending job of |decoding_thread_pool_|, if any, with |*lock|
+  // temporarily released. Returns true if a job was run, in which case the
+  // caller must re-check the condition it is waiting for. |*lock| must hold
+  // |mutex_|.
+  bool RunPendingJob(std::unique_lock<std::mutex>* lock);
+
+  // A thread that is blocked in WaitUntilSlow(). It lives on the stack of that
+  // thread and is linked into |progress_waiters_| while |waiting| is true.
+  struct ProgressWaiter {
+    explicit ProgressWaiter(int row) : row(row) {}
+
+    const int row;
+    bool waiting = true;
+    ProgressWaiter* next = nullptr;
+    std::condition_variable condvar;
+  };
+
+  // Spins, helps with pending jobs and finally blocks until |progress_row_| is
+  // at least |progress_row| or the frame is aborted. Returns the value of
+  // |progress_row_| at that point.
+  int WaitUntilSlow(int progress_row);
+  // Wakes up and unlinks the waiters whose row is <= |progress_row| and
+  // recomputes |min_progress_waiter_row_|. |mutex_| must be held.
+  void WakeProgressWaiters(int progress_row);
+
   BufferPool* pool_ = nullptr;
   bool buffer_private_data_valid_ = false;
   void* buffer_private_data_ = nullptr;
@@ -290,15 +343,22 @@ class RefCountedBuffer {
 
   std::mutex mutex_;
   FrameState frame_state_ = kFrameStateUnknown LIBGAV1_GUARDED_BY(mutex_);
-  int progress_row_ = -1 LIBGAV1_GUARDED_BY(mutex_);
-  // Signaled when progress_row_ is updated or when frame_state_ is set to
-  // kFrameStateDecoded.
-  std::condition_variable progress_row_condvar_;
+  // Written with release semantics so that the pixels of the rows up to
+  // |progress_row_| are visible to the threads that read it with acquire
+  // semantics. It is set to INT_MAX when the frame is decoded.
+  std::atomic<int> progress_row_{-1};
+  // The smallest row that any thread in |progress_waiters_| is waiting on, or
+  // INT_MAX if there are no waiters. It is only written while |mutex_| is held
+  // but is read without it by SetProgress().
+  std::atomic<int> min_progress_waiter_row_{INT_MAX};
+  ProgressWaiter* progress_waiters_ = nullptr LIBGAV1_GUARDED_BY(mutex_);
   // Signaled when the frame state is set to kFrameStateParsed.
   std::condition_variable parsed_condvar_;
   // Signaled when the frame state is set to kFrameStateDecoded.
   std::condition_variable decoded_condvar_;
-  bool abort_ = false LIBGAV1_GUARDED_BY(mutex_);
+  // Only written while |mutex_| is held.
+  std::atomic<bool> abort_{false};
+  ThreadPool* decoding_thread_pool_ = nullptr LIBGAV1_GUARDED_BY(mutex_);
 
   FrameType frame_type_ = kFrameKey;
   ChromaSamplePosition chroma_sample_position_ = kChromaSamplePositionUnknown;
@@ -320,7 +380,7 @@ class RefCountedBuffer {
   // Only the |params| field of each GlobalMotion struct is used.
   // global_motion_[0] (for kReferenceFrameIntra) is not used.
   std::array<GlobalMotion, kNumReferenceFrameTypes> global_motion_ = {};
-  SymbolDecoderContext frame_context_;
+  SymbolDecoderContextPtr frame_context_;
   std::array<int8_t, kNumReferenceFrameTypes> loop_filter_ref_deltas_;
   std::array<int8_t, kLoopFilterMaxModeDeltas> loop_filter_mode_deltas_;
   // Only the feature_enabled, feature_data, segment_id_pre_skip, and
@@ -349,7 +409,8 @@ class BufferPool {
   BufferPool(FrameBufferSizeChangedCallback on_frame_buffer_size_changed,
              GetFrameBufferCallback get_frame_buffer,
              ReleaseFrameBufferCallback release_frame_buffer,
-             void* callback_private_data);
+             void* callback_private_data, bool interleave_numa_nodes,
+             bool use_huge_pages);
 
   // Not copyable or movable.
   BufferPool(const BufferPool&) = delete;
@@ -40,6 +40,14 @@ Libgav1StatusCode Libgav1DecoderCreate(const Libgav1DecoderSettings* settings,
   cxx_settings.output_all_layers = settings->output_all_layers != 0;
   cxx_settings.operating_point = settings->operating_point;
   cxx_settings.post_filter_mask = settings->post_filter_mask;
+  cxx_settings.key_frames_only = settings->key_frames_only != 0;
+  cxx_settings.inter_post_filter_mask = settings->inter_post_filter_mask;
+  cxx_settings.preview_scale_log2 = settings->preview_scale_log2;
+  cxx_settings.shared_thread_pool = settings->shared_thread_pool != 0;
+  cxx_settings.schedule_job = settings->schedule_job;
+  cxx_settings.interleave_numa_nodes = settings->interleave_numa_nodes != 0;
+  cxx_settings.use_huge_pages = settings->use_huge_pages != 0;
+  cxx_settings.parse_ahead = settings->parse_ahead != 0;
 
   const Libgav1StatusCode status = cxx_decoder->Init(&cxx_settings);
   if (status == kLibgav1StatusOk) {
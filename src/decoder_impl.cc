@@ -47,6 +47,38 @@ namespace {
 
 constexpr int kMaxBlockWidth4x4 = 32;
 constexpr int kMaxBlockHeight4x4 = 32;
+// The maximum number of frames of a temporal unit that are parsed ahead and
+// not yet waited for: the frame being reconstructed and the frame parsed after
+// it.
+constexpr int kMaxParseAheadFrames = 2;
+
+// Averages every (1 << |scale_log2|)x(1 << |scale_log2|) block of the
+// |src_width|x|src_height| plane |src| into one pixel of the
+// |dst_width|x|dst_height| plane |dst|. The blocks are clipped at the right
+// and bottom edges of |src|. The strides are in bytes.
+template <typename Pixel>
+void DownscalePlane(const uint8_t* src, int src_stride, int src_width,
+                    int src_height, int scale_log2, uint8_t* dst,
+                    int dst_stride, int dst_width, int dst_height) {
+  const int scale = 1 << scale_log2;
+  for (int y = 0; y < dst_height; ++y) {
+    const int y0 = y << scale_log2;
+    const int rows = std::min(scale, src_height - y0);
+    auto* const dst_row = reinterpret_cast<Pixel*>(dst + y * dst_stride);
+    for (int x = 0; x < dst_width; ++x) {
+      const int x0 = x << scale_log2;
+      const int columns = std::min(scale, src_width - x0);
+      int sum = 0;
+      for (int i = 0; i < rows; ++i) {
+        const auto* const src_row =
+            reinterpret_cast<const Pixel*>(src + (y0 + i) * src_stride);
+        for (int j = 0; j < columns; ++j) sum += src_row[x0 + j];
+      }
+      const int count = rows * columns;
+      dst_row[x] = static_cast<Pixel>((sum + (count >> 1)) / count);
+    }
+  }
+}
 
 // Computes the bottom border size in pixels. If CDEF, loop restoration or
 // SuperRes is enabled, adds extra border pixels to facilitate those steps to
@@ -104,6 +136,47 @@ class FrameScratchBufferReleaser {
   std::unique_ptr<FrameScratchBuffer>* const frame_scratch_buffer_;
 };
 
+// Helper class that makes |thread_pool| the decoding thread pool of |frame| for
+// the lifetime of the object. See RefCountedBuffer::SetDecodingThreadPool().
+// All the jobs scheduled on |thread_pool| for |frame| must be complete before
+// the object is destroyed.
+class DecodingThreadPoolSetter {
+ public:
+  DecodingThreadPoolSetter(RefCountedBuffer* const frame,
+                           ThreadPool* const thread_pool)
+      : frame_(frame) {
+    frame_->SetDecodingThreadPool(thread_pool);
+  }
+  ~DecodingThreadPoolSetter() { frame_->SetDecodingThreadPool(nullptr); }
+
+ private:
+  RefCountedBuffer* const frame_;
+};
+
+// Returns true if the last call to |obu|.ParseOneFrame() parsed a sequence
+// header OBU.
+bool HasSequenceHeaderObu(const ObuParser& obu) {
+  return std::find_if(obu.obu_headers().begin(), obu.obu_headers().end(),
+                      [](const ObuHeader& obu_header) {
+                        return obu_header.type == kObuSequenceHeader;
+                      }) != obu.obu_headers().end();
+}
+
+#ifndef NDEBUG
+// Returns true if all the |tile_buffers| point into the |size| bytes at
+// |data|, i.e., no tile data was copied out of the temporal unit.
+bool TileBuffersAreInTemporalUnit(const Vector<TileBuffer>& tile_buffers,
+                                  const uint8_t* data, size_t size) {
+  for (const auto& tile_buffer : tile_buffers) {
+    if (tile_buffer.data < data ||
+        tile_buffer.data + tile_buffer.size > data + size) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif
+
 // Sets the |frame|'s segmentation map for two cases. The third case is handled
 // in Tile::DecodeBlock().
 void SetSegmentationMap(const ObuFrameHeader& frame_header,
@@ -124,6 +197,21 @@ void SetSegmentationMap(const ObuFrameHeader& frame_header,
   }
 }
 
+// Saves the CDF tables of |frame|. If enable_frame_end_update_cdf is true,
+// these are the tables saved by the context update tile. Otherwise they are the
+// tables at the start of the frame, which are shared rather than copied.
+void SetFrameContext(
+    const ObuFrameHeader& frame_header,
+    const SymbolDecoderContextPtr& symbol_decoder_context,
+    std::unique_ptr<SymbolDecoderContext>* const saved_symbol_decoder_context,
+    RefCountedBuffer* const frame) {
+  if (frame_header.enable_frame_end_update_cdf) {
+    frame->SetFrameContext(std::move(*saved_symbol_decoder_context));
+  } else {
+    frame->ShareFrameContext(symbol_decoder_context);
+  }
+}
+
 StatusCode DecodeTilesNonFrameParallel(
     const ObuSequenceHeader& sequence_header,
     const ObuFrameHeader& frame_header,
@@ -212,28 +300,37 @@ StatusCode DecodeTilesThreadedNonFrameParallel(
   return kStatusOk;
 }
 
-StatusCode DecodeTilesFrameParallel(
-    const ObuSequenceHeader& sequence_header,
+// Parses all the tiles of the frame and marks |current_frame| as parsed. Used
+// when the parsing and the decoding of a frame are done separately.
+StatusCode ParseFrame(
     const ObuFrameHeader& frame_header,
     const Vector<std::unique_ptr<Tile>>& tiles,
-    const SymbolDecoderContext& saved_symbol_decoder_context,
+    std::unique_ptr<SymbolDecoderContext>* const saved_symbol_decoder_context,
     const SegmentationMap* const prev_segment_ids,
     FrameScratchBuffer* const frame_scratch_buffer,
-    PostFilter* const post_filter, RefCountedBuffer* const current_frame) {
-  // Parse the frame.
+    RefCountedBuffer* const current_frame) {
   for (const auto& tile : tiles) {
     if (!tile->Parse()) {
       LIBGAV1_DLOG(ERROR, "Failed to parse tile number: %d\n", tile->number());
       return kStatusUnknownError;
     }
   }
-  if (frame_header.enable_frame_end_update_cdf) {
-    frame_scratch_buffer->symbol_decoder_context = saved_symbol_decoder_context;
-  }
-  current_frame->SetFrameContext(frame_scratch_buffer->symbol_decoder_context);
+  SetFrameContext(frame_header, frame_scratch_buffer->symbol_decoder_context,
+                  saved_symbol_decoder_context, current_frame);
   SetSegmentationMap(frame_header, prev_segment_ids, current_frame);
   // Mark frame as parsed.
   current_frame->SetFrameState(kFrameStateParsed);
+  return kStatusOk;
+}
+
+// Decodes the parsed |tiles| and applies the post filters one superblock row
+// at a time, updating the progress of |current_frame| as it goes.
+StatusCode ReconstructFrame(const ObuSequenceHeader& sequence_header,
+                            const ObuFrameHeader& frame_header,
+                            const Vector<std::unique_ptr<Tile>>& tiles,
+                            FrameScratchBuffer* const frame_scratch_buffer,
+                            PostFilter* const post_filter,
+                            RefCountedBuffer* const current_frame) {
   std::unique_ptr<TileScratchBuffer> tile_scratch_buffer =
       frame_scratch_buffer->tile_scratch_buffer_pool.Get();
   if (tile_scratch_buffer == nullptr) {
@@ -267,6 +364,34 @@ StatusCode DecodeTilesFrameParallel(
   return kStatusOk;
 }
 
+StatusCode DecodeTilesFrameParallel(
+    const ObuSequenceHeader& sequence_header,
+    const ObuFrameHeader& frame_header,
+    const Vector<std::unique_ptr<Tile>>& tiles,
+    std::unique_ptr<SymbolDecoderContext>* const saved_symbol_decoder_context,
+    const SegmentationMap* const prev_segment_ids,
+    FrameScratchBuffer* const frame_scratch_buffer,
+    PostFilter* const post_filter, RefCountedBuffer* const current_frame) {
+  const StatusCode status =
+      ParseFrame(frame_header, tiles, saved_symbol_decoder_context,
+                 prev_segment_ids, frame_scratch_buffer, current_frame);
+  if (status != kStatusOk) return status;
+  return ReconstructFrame(sequence_header, frame_header, tiles,
+                          frame_scratch_buffer, post_filter, current_frame);
+}
+
+// Waits for all the frames in |parse_ahead_frames| to be reconstructed and
+// removes them from the queue.
+StatusCode WaitForParseAheadFrames(
+    Queue<std::unique_ptr<ParseAheadFrame>>* const parse_ahead_frames) {
+  bool ok = true;
+  while (!parse_ahead_frames->Empty()) {
+    ok &= parse_ahead_frames->Front()->Wait();
+    parse_ahead_frames->Pop();
+  }
+  return ok ? kStatusOk : kStatusUnknownError;
+}
+
 // Helper function used by DecodeTilesThreadedFrameParallel. Applies the
 // deblocking filter for tile boundaries for the superblock row at |row4x4|.
 void ApplyDeblockingFilterForTileBoundaries(
@@ -415,13 +540,17 @@ StatusCode DecodeTilesThreadedFrameParallel(
     const ObuSequenceHeader& sequence_header,
     const ObuFrameHeader& frame_header,
     const Vector<std::unique_ptr<Tile>>& tiles,
-    const SymbolDecoderContext& saved_symbol_decoder_context,
+    std::unique_ptr<SymbolDecoderContext>* const saved_symbol_decoder_context,
     const SegmentationMap* const prev_segment_ids,
     FrameScratchBuffer* const frame_scratch_buffer,
     PostFilter* const post_filter, RefCountedBuffer* const current_frame) {
   // Parse the frame.
   ThreadPool& thread_pool =
       *frame_scratch_buffer->threading_strategy.thread_pool();
+  // Threads of the newer frames that are waiting on this frame will help with
+  // its jobs. Every return path below waits for the jobs to complete.
+  DecodingThreadPoolSetter decoding_thread_pool_setter(current_frame,
+                                                       &thread_pool);
   std::atomic<int> tile_counter(0);
   const int tile_count = static_cast<int>(tiles.size());
   const int num_workers = thread_pool.num_threads();
@@ -464,10 +593,8 @@ StatusCode DecodeTilesThreadedFrameParallel(
   if (!parse_workers.Wait() || failed) {
     return kLibgav1StatusUnknownError;
   }
-  if (frame_header.enable_frame_end_update_cdf) {
-    frame_scratch_buffer->symbol_decoder_context = saved_symbol_decoder_context;
-  }
-  current_frame->SetFrameContext(frame_scratch_buffer->symbol_decoder_context);
+  SetFrameContext(frame_header, frame_scratch_buffer->symbol_decoder_context,
+                  saved_symbol_decoder_context, current_frame);
   SetSegmentationMap(frame_header, prev_segment_ids, current_frame);
   current_frame->SetFrameState(kFrameStateParsed);
 
@@ -583,6 +710,39 @@ StatusCode DecodeTilesThreadedFrameParallel(
 
 }  // namespace
 
+ParseAheadFrame::~ParseAheadFrame() {
+  if (scheduled_ && !waited_) reconstructed_.Wait();
+  // The tiles and the post filter use |frame_scratch_buffer|.
+  tiles.clear();
+  post_filter = nullptr;
+  if (frame_scratch_buffer != nullptr) {
+    frame_scratch_buffer_pool_->Release(std::move(frame_scratch_buffer));
+  }
+}
+
+void ParseAheadFrame::Schedule(ThreadPool* const thread_pool) {
+  assert(!scheduled_);
+  scheduled_ = true;
+  thread_pool->Schedule([this]() { Reconstruct(); });
+}
+
+bool ParseAheadFrame::Wait() {
+  assert(scheduled_ && !waited_);
+  waited_ = true;
+  return reconstructed_.Wait();
+}
+
+void ParseAheadFrame::Reconstruct() {
+  const bool ok =
+      ReconstructFrame(sequence_header, frame_header, tiles,
+                       frame_scratch_buffer.get(), post_filter.get(),
+                       frame.get()) == kStatusOk;
+  // The frames that are parsed after this one may wait on its progress, so it
+  // is marked as decoded even on failure. The failure is reported by Wait().
+  if (!ok) frame->SetFrameState(kFrameStateDecoded);
+  reconstructed_.Decrement(ok);
+}
+
 // static
 StatusCode DecoderImpl::Create(const DecoderSettings* settings,
                                std::unique_ptr<DecoderImpl>* output) {
@@ -590,6 +750,11 @@ StatusCode DecoderImpl::Create(const DecoderSettings* settings,
     LIBGAV1_DLOG(ERROR, "Invalid settings->threads: %d.", settings->threads);
     return kStatusInvalidArgument;
   }
+  if (settings->preview_scale_log2 < 0 || settings->preview_scale_log2 > 2) {
+    LIBGAV1_DLOG(ERROR, "Invalid settings->preview_scale_log2: %d.",
+                 settings->preview_scale_log2);
+    return kStatusInvalidArgument;
+  }
   if (settings->frame_parallel) {
     if (settings->release_input_buffer == nullptr) {
       LIBGAV1_DLOG(ERROR,
@@ -612,7 +777,8 @@ StatusCode DecoderImpl::Create(const DecoderSettings* settings,
 DecoderImpl::DecoderImpl(const DecoderSettings* settings)
     : buffer_pool_(settings->on_frame_buffer_size_changed,
                    settings->get_frame_buffer, settings->release_frame_buffer,
-                   settings->callback_private_data),
+                   settings->callback_private_data,
+                   settings->interleave_numa_nodes, settings->use_huge_pages),
       settings_(*settings) {
   dsp::DspInit();
 }
@@ -631,21 +797,45 @@ DecoderImpl::~DecoderImpl() {
 }
 
 StatusCode DecoderImpl::Init() {
-  if (!GenerateWedgeMask(&wedge_masks_)) {
-    LIBGAV1_DLOG(ERROR, "GenerateWedgeMask() failed.");
+  wedge_masks_ = GetWedgeMasks();
+  if (wedge_masks_ == nullptr) {
+    LIBGAV1_DLOG(ERROR, "GetWedgeMasks() failed.");
     return kStatusOutOfMemory;
   }
   if (!output_frame_queue_.Init(kMaxLayers)) {
     LIBGAV1_DLOG(ERROR, "output_frame_queue_.Init() failed.");
     return kStatusOutOfMemory;
   }
+  if (settings_.schedule_job != nullptr && settings_.threads > 1) {
+    // The current thread also does some of the work, as in
+    // ThreadingStrategy::Reset().
+    const int thread_count =
+        std::min(settings_.threads, static_cast<int>(kMaxThreads)) - 1;
+    external_thread_pool_ =
+        ThreadPool::Create(settings_.schedule_job,
+                           settings_.callback_private_data, thread_count);
+    if (external_thread_pool_ == nullptr) {
+      LIBGAV1_DLOG(ERROR, "Failed to create the external thread pool.");
+      return kStatusOutOfMemory;
+    }
+    shared_thread_pool_ = external_thread_pool_.get();
+  } else if (settings_.shared_thread_pool && settings_.threads > 1) {
+    shared_thread_pool_ = GetSharedThreadPool(settings_.threads);
+    if (shared_thread_pool_ == nullptr) {
+      LIBGAV1_DLOG(ERROR, "GetSharedThreadPool() failed.");
+      return kStatusOutOfMemory;
+    }
+  }
   return kStatusOk;
 }
 
 StatusCode DecoderImpl::InitializeFrameThreadPoolAndTemporalUnitQueue(
     const uint8_t* data, size_t size) {
   is_frame_parallel_ = false;
-  if (settings_.frame_parallel) {
+  // Frame parallel mode blocks inside the worker jobs, so it is not used with
+  // the shared or the external thread pool.
+  if (settings_.frame_parallel && !settings_.shared_thread_pool &&
+      settings_.schedule_job == nullptr) {
     DecoderState state;
     std::unique_ptr<ObuParser> obu(new (std::nothrow) ObuParser(
         data, size, settings_.operating_point, &buffer_pool_, &state));
@@ -679,6 +869,13 @@ StatusCode DecoderImpl::InitializeFrameThreadPoolAndTemporalUnitQueue(
     return kStatusOutOfMemory;
   }
   is_frame_parallel_ = frame_thread_pool_ != nullptr;
+  if (settings_.parse_ahead && !is_frame_parallel_) {
+    parse_ahead_thread_pool_ = ThreadPool::Create("libgav1-pa", 1);
+    if (parse_ahead_thread_pool_ == nullptr) {
+      LIBGAV1_DLOG(ERROR, "Failed to create the parse ahead thread pool.");
+      return kStatusOutOfMemory;
+    }
+  }
   return kStatusOk;
 }
 
@@ -854,7 +1051,7 @@ StatusCode DecoderImpl::ParseAndSchedule(const uint8_t* data, size_t size,
       return status;
     }
     if (!MaybeInitializeQuantizerMatrix(obu->frame_header())) {
-      LIBGAV1_DLOG(ERROR, "InitializeQuantizerMatrix() failed.");
+      LIBGAV1_DLOG(ERROR, "GetQuantizerMatrix() failed.");
       return kStatusOutOfMemory;
     }
     if (IsNewSequenceHeader(*obu)) {
@@ -876,6 +1073,16 @@ StatusCode DecoderImpl::ParseAndSchedule(const uint8_t* data, size_t size,
         return kStatusUnknownError;
       }
     }
+    // The frames share the sequence header until a new sequence header OBU is
+    // seen, so scheduling a frame does not copy it.
+    if (shared_sequence_header_ == nullptr || HasSequenceHeaderObu(*obu)) {
+      shared_sequence_header_.reset(
+          new (std::nothrow) ObuSequenceHeader(obu->sequence_header()));
+      if (shared_sequence_header_ == nullptr) {
+        LIBGAV1_DLOG(ERROR, "Failed to allocate the sequence header.");
+        return kStatusOutOfMemory;
+      }
+    }
     // This can happen when there are multiple spatial/temporal layers and if
     // all the layers are outside the current operating point.
     if (current_frame == nullptr) {
@@ -884,11 +1091,16 @@ StatusCode DecoderImpl::ParseAndSchedule(const uint8_t* data, size_t size,
     // Note that we cannot set EncodedFrame.temporal_unit here. It will be set
     // in the code below after |temporal_unit| is std::move'd into the
     // |temporal_units_| queue.
-    if (!temporal_unit.frames.emplace_back(obu.get(), state_, current_frame,
+    if (!temporal_unit.frames.emplace_back(obu.get(), shared_sequence_header_,
+                                           state_, current_frame,
                                            position_in_temporal_unit++)) {
       LIBGAV1_DLOG(ERROR, "temporal_unit.frames.emplace_back failed.");
       return kStatusOutOfMemory;
     }
+    // The tile data is decoded in place from the caller's buffer.
+    assert(TileBuffersAreInTemporalUnit(
+        temporal_unit.frames.back().tile_buffers, temporal_unit.data,
+        temporal_unit.size));
     state_.UpdateReferenceFrames(current_frame,
                                  obu->frame_header().refresh_frame_flags);
   }
@@ -940,9 +1152,17 @@ StatusCode DecoderImpl::ParseAndSchedule(const uint8_t* data, size_t size,
 }
 
 StatusCode DecoderImpl::DecodeFrame(EncodedFrame* const encoded_frame) {
-  const ObuSequenceHeader& sequence_header = encoded_frame->sequence_header;
+  const ObuSequenceHeader& sequence_header = *encoded_frame->sequence_header;
   const ObuFrameHeader& frame_header = encoded_frame->frame_header;
   RefCountedBufferPtr current_frame = std::move(encoded_frame->frame);
+  if (SkipFrame(*current_frame)) {
+    // No other frame reads the pixels of a skipped frame, but mark it as
+    // decoded so that nothing can wait on it forever.
+    if (!frame_header.show_existing_frame) {
+      current_frame->SetFrameState(kFrameStateDecoded);
+    }
+    return kStatusOk;
+  }
 
   std::unique_ptr<FrameScratchBuffer> frame_scratch_buffer =
       frame_scratch_buffer_pool_.Get();
@@ -966,7 +1186,8 @@ StatusCode DecoderImpl::DecodeFrame(EncodedFrame* const encoded_frame) {
     }
     status = DecodeTiles(sequence_header, frame_header,
                          encoded_frame->tile_buffers, encoded_frame->state,
-                         frame_scratch_buffer.get(), current_frame.get());
+                         frame_scratch_buffer.get(), current_frame.get(),
+                         /*parse_ahead_frame=*/nullptr);
     if (status != kStatusOk) {
       return status;
     }
@@ -987,6 +1208,13 @@ StatusCode DecoderImpl::DecodeFrame(EncodedFrame* const encoded_frame) {
     return status;
   }
 
+  if (settings_.preview_scale_log2 != 0) {
+    status = DownscaleFrame(film_grain_frame, &film_grain_frame);
+    if (status != kStatusOk) {
+      return status;
+    }
+  }
+
   TemporalUnit& temporal_unit = *encoded_frame->temporal_unit;
   std::lock_guard<std::mutex> lock(mutex_);
   if (temporal_unit.has_displayable_frame && !settings_.output_all_layers) {
@@ -1038,6 +1266,15 @@ StatusCode DecoderImpl::DecodeTemporalUnit(const TemporalUnit& temporal_unit,
   // of scope (i.e.) on any return path in this function.
   FrameScratchBufferReleaser frame_scratch_buffer_releaser(
       &frame_scratch_buffer_pool_, &frame_scratch_buffer);
+  // The frames that are being reconstructed by |parse_ahead_thread_pool_|, in
+  // decoding order. On any return path, the elements wait for their
+  // reconstruction when this local variable goes out of scope.
+  Queue<std::unique_ptr<ParseAheadFrame>> parse_ahead_frames;
+  if (parse_ahead_thread_pool_ != nullptr &&
+      !parse_ahead_frames.Init(kMaxParseAheadFrames)) {
+    LIBGAV1_DLOG(ERROR, "parse_ahead_frames.Init() failed.");
+    return kStatusOutOfMemory;
+  }
 
   while (obu->HasData()) {
     RefCountedBufferPtr current_frame;
@@ -1047,10 +1284,13 @@ StatusCode DecoderImpl::DecodeTemporalUnit(const TemporalUnit& temporal_unit,
       return status;
     }
     if (!MaybeInitializeQuantizerMatrix(obu->frame_header())) {
-      LIBGAV1_DLOG(ERROR, "InitializeQuantizerMatrix() failed.");
+      LIBGAV1_DLOG(ERROR, "GetQuantizerMatrix() failed.");
       return kStatusOutOfMemory;
     }
     if (IsNewSequenceHeader(*obu)) {
+      // The frame buffers may be reallocated below.
+      status = WaitForParseAheadFrames(&parse_ahead_frames);
+      if (status != kStatusOk) return status;
       const ObuSequenceHeader& sequence_header = obu->sequence_header();
       const Libgav1ImageFormat image_format =
           ComposeImageFormat(sequence_header.color_config.is_monochrome,
@@ -1067,6 +1307,7 @@ StatusCode DecoderImpl::DecodeTemporalUnit(const TemporalUnit& temporal_unit,
         return kStatusUnknownError;
       }
     }
+    const bool skip_frame = SkipFrame(*current_frame);
     if (!obu->frame_header().show_existing_frame) {
       if (obu->tile_buffers().empty()) {
         // This means that the last call to ParseOneFrame() did not actually
@@ -1075,17 +1316,41 @@ StatusCode DecoderImpl::DecodeTemporalUnit(const TemporalUnit& temporal_unit,
         // not have a reason to handle those cases, so we simply continue.
         continue;
       }
-      status = DecodeTiles(obu->sequence_header(), obu->frame_header(),
-                           obu->tile_buffers(), state_,
-                           frame_scratch_buffer.get(), current_frame.get());
-      if (status != kStatusOk) {
-        return status;
+      // Only the reference state is updated for the skipped frames.
+      if (!skip_frame) {
+        // A frame is parsed ahead if the parsing of the next frame can overlap
+        // with its reconstruction, or if its own parsing can overlap with the
+        // reconstruction of the previous frames. The other frames are decoded
+        // with the regular (possibly multi-threaded) path, once the frames
+        // they may refer to have been reconstructed.
+        if (parse_ahead_thread_pool_ != nullptr &&
+            obu->frame_header().tile_info.tile_count == 1 &&
+            (obu->HasData() || !parse_ahead_frames.Empty())) {
+          status = ParseAhead(*obu, current_frame, &parse_ahead_frames);
+        } else {
+          status = WaitForParseAheadFrames(&parse_ahead_frames);
+          if (status != kStatusOk) return status;
+          status = DecodeTiles(obu->sequence_header(), obu->frame_header(),
+                               obu->tile_buffers(), state_,
+                               frame_scratch_buffer.get(), current_frame.get(),
+                               /*parse_ahead_frame=*/nullptr);
+          // The frames that are parsed ahead wait on the progress of their
+          // reference frames.
+          if (status == kStatusOk && parse_ahead_thread_pool_ != nullptr) {
+            current_frame->SetFrameState(kFrameStateDecoded);
+          }
+        }
+        if (status != kStatusOk) {
+          return status;
+        }
       }
     }
     state_.UpdateReferenceFrames(current_frame,
                                  obu->frame_header().refresh_frame_flags);
-    if (obu->frame_header().show_frame ||
-        obu->frame_header().show_existing_frame) {
+    if (!skip_frame && (obu->frame_header().show_frame ||
+                        obu->frame_header().show_existing_frame)) {
+      status = WaitForParseAheadFrames(&parse_ahead_frames);
+      if (status != kStatusOk) return status;
       if (!output_frame_queue_.Empty() && !settings_.output_all_layers) {
         // There is more than one displayable frame in the current operating
         // point and |settings_.output_all_layers| is false. In this case, we
@@ -1100,9 +1365,15 @@ StatusCode DecoderImpl::DecodeTemporalUnit(const TemporalUnit& temporal_unit,
           &film_grain_frame,
           frame_scratch_buffer->threading_strategy.film_grain_thread_pool());
       if (status != kStatusOk) return status;
+      if (settings_.preview_scale_log2 != 0) {
+        status = DownscaleFrame(film_grain_frame, &film_grain_frame);
+        if (status != kStatusOk) return status;
+      }
       output_frame_queue_.Push(std::move(film_grain_frame));
     }
   }
+  status = WaitForParseAheadFrames(&parse_ahead_frames);
+  if (status != kStatusOk) return status;
   if (output_frame_queue_.Empty()) {
     // No displayable frame in the temporal unit. Not an error.
     *out_ptr = nullptr;
@@ -1179,11 +1450,45 @@ void DecoderImpl::ReleaseOutputFrame() {
   output_frame_ = nullptr;
 }
 
+StatusCode DecoderImpl::ParseAhead(
+    const ObuParser& obu, const RefCountedBufferPtr& current_frame,
+    Queue<std::unique_ptr<ParseAheadFrame>>* const parse_ahead_frames) {
+  if (parse_ahead_frames->Full()) {
+    const bool ok = parse_ahead_frames->Front()->Wait();
+    parse_ahead_frames->Pop();
+    if (!ok) return kStatusUnknownError;
+  }
+  std::unique_ptr<ParseAheadFrame> parse_ahead_frame(
+      new (std::nothrow) ParseAheadFrame(
+          obu.sequence_header(), obu.frame_header(), state_, current_frame,
+          &parse_ahead_frame_scratch_buffer_pool_));
+  if (parse_ahead_frame == nullptr) {
+    LIBGAV1_DLOG(ERROR, "Failed to allocate ParseAheadFrame.");
+    return kStatusOutOfMemory;
+  }
+  parse_ahead_frame->frame_scratch_buffer =
+      parse_ahead_frame_scratch_buffer_pool_.Get();
+  if (parse_ahead_frame->frame_scratch_buffer == nullptr) {
+    LIBGAV1_DLOG(ERROR, "Error when getting FrameScratchBuffer.");
+    return kStatusOutOfMemory;
+  }
+  const StatusCode status = DecodeTiles(
+      parse_ahead_frame->sequence_header, parse_ahead_frame->frame_header,
+      obu.tile_buffers(), parse_ahead_frame->state,
+      parse_ahead_frame->frame_scratch_buffer.get(), current_frame.get(),
+      parse_ahead_frame.get());
+  if (status != kStatusOk) return status;
+  parse_ahead_frame->Schedule(parse_ahead_thread_pool_.get());
+  parse_ahead_frames->Push(std::move(parse_ahead_frame));
+  return kStatusOk;
+}
+
 StatusCode DecoderImpl::DecodeTiles(
     const ObuSequenceHeader& sequence_header,
     const ObuFrameHeader& frame_header, const Vector<TileBuffer>& tile_buffers,
     const DecoderState& state, FrameScratchBuffer* const frame_scratch_buffer,
-    RefCountedBuffer* const current_frame) {
+    RefCountedBuffer* const current_frame,
+    ParseAheadFrame* const parse_ahead_frame) {
   frame_scratch_buffer->tile_scratch_buffer_pool.Reset(
       sequence_header.color_config.bitdepth);
   if (!frame_scratch_buffer->loop_restoration_info.Reset(
@@ -1197,19 +1502,22 @@ StatusCode DecoderImpl::DecodeTiles(
   }
   ThreadingStrategy& threading_strategy =
       frame_scratch_buffer->threading_strategy;
-  if (!is_frame_parallel_ &&
-      !threading_strategy.Reset(frame_header, settings_.threads)) {
+  // The threading strategy of the frames that are parsed ahead is never reset,
+  // so these frames are reconstructed and post filtered by a single thread.
+  if (!is_frame_parallel_ && parse_ahead_frame == nullptr &&
+      !threading_strategy.Reset(frame_header, settings_.threads,
+                                shared_thread_pool_)) {
     return kStatusOutOfMemory;
   }
-  const bool do_cdef =
-      PostFilter::DoCdef(frame_header, settings_.post_filter_mask);
+  const uint8_t post_filter_mask = GetPostFilterMask(frame_header.frame_type);
+  const bool do_cdef = PostFilter::DoCdef(frame_header, post_filter_mask);
   const int num_planes = sequence_header.color_config.is_monochrome
                              ? kMaxPlanesMonochrome
                              : kMaxPlanes;
   const bool do_restoration = PostFilter::DoRestoration(
-      frame_header.loop_restoration, settings_.post_filter_mask, num_planes);
+      frame_header.loop_restoration, post_filter_mask, num_planes);
   const bool do_superres =
-      PostFilter::DoSuperRes(frame_header, settings_.post_filter_mask);
+      PostFilter::DoSuperRes(frame_header, post_filter_mask);
   // Use kBorderPixels for the left, right, and top borders. Only the bottom
   // border may need to be bigger. Cdef border is needed only if we apply Cdef
   // without multithreading.
@@ -1245,6 +1553,26 @@ StatusCode DecoderImpl::DecodeTiles(
     LIBGAV1_DLOG(ERROR, "Failed to allocate memory for inter_transform_sizes.");
     return kStatusOutOfMemory;
   }
+  if (PostFilter::DoDeblock(frame_header, post_filter_mask)) {
+    DeblockFilterEdges& edges = frame_scratch_buffer->deblock_filter_edges;
+    bool ok = true;
+    for (int type = 0; type < kNumLoopFilterTypes; ++type) {
+      for (auto& levels : edges.levels[type]) {
+        ok = ok && levels.Reset(frame_header.rows4x4, frame_header.columns4x4,
+                                /*zero_initialize=*/false);
+      }
+      for (auto& filter_lengths : edges.filter_lengths[type]) {
+        ok = ok && filter_lengths.Reset(frame_header.rows4x4,
+                                        frame_header.columns4x4,
+                                        /*zero_initialize=*/false);
+      }
+    }
+    if (!ok) {
+      LIBGAV1_DLOG(ERROR,
+                   "Failed to allocate memory for deblock_filter_edges.");
+      return kStatusOutOfMemory;
+    }
+  }
   if (frame_header.use_ref_frame_mvs) {
     if (!frame_scratch_buffer->motion_field.mv.Reset(
             DivideBy2(frame_header.rows4x4), DivideBy2(frame_header.columns4x4),
@@ -1256,21 +1584,8 @@ StatusCode DecoderImpl::DecodeTiles(
                    "Failed to allocate memory for temporal motion vectors.");
       return kStatusOutOfMemory;
     }
-
-    // For each motion vector, only mv[0] needs to be initialized to
-    // kInvalidMvValue, mv[1] is not necessary to be initialized and can be
-    // set to an arbitrary value. For simplicity, mv[1] is set to 0.
-    // The following memory initialization of contiguous memory is very fast. It
-    // is not recommended to make the initialization multi-threaded, unless the
-    // memory which needs to be initialized in each thread is still contiguous.
-    MotionVector invalid_mv;
-    invalid_mv.mv[0] = kInvalidMvValue;
-    invalid_mv.mv[1] = 0;
-    MotionVector* const motion_field_mv =
-        &frame_scratch_buffer->motion_field.mv[0][0];
-    std::fill(motion_field_mv,
-              motion_field_mv + frame_scratch_buffer->motion_field.mv.size(),
-              invalid_mv);
+    // The motion field is initialized and projected one superblock row at a
+    // time by the tiles, just before the row is parsed.
   }
 
   // The addition of kMaxBlockHeight4x4 and kMaxBlockWidth4x4 is necessary so
@@ -1298,15 +1613,14 @@ StatusCode DecoderImpl::DecodeTiles(
     return kStatusOutOfMemory;
   }
 
-  if (threading_strategy.row_thread_pool(0) != nullptr || is_frame_parallel_) {
+  if (threading_strategy.row_thread_pool(0) != nullptr || is_frame_parallel_ ||
+      parse_ahead_frame != nullptr) {
     if (frame_scratch_buffer->residual_buffer_pool == nullptr) {
       frame_scratch_buffer->residual_buffer_pool.reset(
           new (std::nothrow) ResidualBufferPool(
               sequence_header.use_128x128_superblock,
               sequence_header.color_config.subsampling_x,
-              sequence_header.color_config.subsampling_y,
-              sequence_header.color_config.bitdepth == 8 ? sizeof(int16_t)
-                                                         : sizeof(int32_t)));
+              sequence_header.color_config.subsampling_y));
       if (frame_scratch_buffer->residual_buffer_pool == nullptr) {
         LIBGAV1_DLOG(ERROR, "Failed to allocate residual buffer.\n");
         return kStatusOutOfMemory;
@@ -1315,9 +1629,7 @@ StatusCode DecoderImpl::DecodeTiles(
       frame_scratch_buffer->residual_buffer_pool->Reset(
           sequence_header.use_128x128_superblock,
           sequence_header.color_config.subsampling_x,
-          sequence_header.color_config.subsampling_y,
-          sequence_header.color_config.bitdepth == 8 ? sizeof(int16_t)
-                                                     : sizeof(int32_t));
+          sequence_header.color_config.subsampling_y);
     }
   }
 
@@ -1356,6 +1668,22 @@ StatusCode DecoderImpl::DecodeTiles(
             kBorderPixels, nullptr, nullptr, nullptr)) {
       return kStatusOutOfMemory;
     }
+    const int num_threads =
+        (threading_strategy.post_filter_thread_pool() != nullptr)
+            ? threading_strategy.post_filter_thread_pool()->num_threads() + 1
+            : 1;
+    // subsampling_y is set to zero irrespective of the actual frame's
+    // subsampling since every thread needs kRestorationUnitHeight rows. The
+    // borders are the same as the frame buffer's so that the strides match.
+    if (!frame_scratch_buffer->loop_restoration_unit_buffer.Realloc(
+            sequence_header.color_config.bitdepth,
+            sequence_header.color_config.is_monochrome,
+            frame_header.upscaled_width, kRestorationUnitHeight * num_threads,
+            sequence_header.color_config.subsampling_x,
+            /*subsampling_y=*/0, kBorderPixels, kBorderPixels, kBorderPixels,
+            kBorderPixels, nullptr, nullptr, nullptr)) {
+      return kStatusOutOfMemory;
+    }
   }
 
   if (do_superres) {
@@ -1403,9 +1731,13 @@ StatusCode DecoderImpl::DecodeTiles(
     }
   }
 
-  PostFilter post_filter(frame_header, sequence_header, frame_scratch_buffer,
-                         current_frame->buffer(), dsp,
-                         settings_.post_filter_mask);
+  std::unique_ptr<PostFilter> post_filter(new (std::nothrow) PostFilter(
+      frame_header, sequence_header, frame_scratch_buffer,
+      current_frame->buffer(), dsp, post_filter_mask));
+  if (post_filter == nullptr) {
+    LIBGAV1_DLOG(ERROR, "Failed to allocate the post filter.");
+    return kStatusOutOfMemory;
+  }
 
   if (is_frame_parallel_ && !IsIntraFrame(frame_header.frame_type)) {
     // We can parse the current frame if all the reference frames have been
@@ -1421,8 +1753,15 @@ StatusCode DecoderImpl::DecodeTiles(
   // a segmentation map containing all 0s.
   const SegmentationMap* prev_segment_ids = nullptr;
   if (frame_header.primary_reference_frame == kPrimaryReferenceNone) {
-    frame_scratch_buffer->symbol_decoder_context.Initialize(
-        frame_header.quantizer.base_index);
+    std::unique_ptr<SymbolDecoderContext> symbol_decoder_context(
+        new (std::nothrow)
+            SymbolDecoderContext(frame_header.quantizer.base_index));
+    if (symbol_decoder_context == nullptr) {
+      LIBGAV1_DLOG(ERROR, "Failed to allocate symbol decoder context.");
+      return kStatusOutOfMemory;
+    }
+    frame_scratch_buffer->symbol_decoder_context =
+        std::move(symbol_decoder_context);
   } else {
     const int index =
         frame_header
@@ -1442,10 +1781,12 @@ StatusCode DecoderImpl::DecodeTiles(
   // only when one of the following conditions are true:
   //   * is_frame_parallel_ is true.
   //   * settings_.threads == 1.
+  //   * The frame is parsed ahead.
   // In the non-frame-parallel multi-threaded case, we do not run the post
   // filters in the decode loop. So this buffer need not be used.
   const bool use_intra_prediction_buffer =
-      is_frame_parallel_ || settings_.threads == 1;
+      is_frame_parallel_ || settings_.threads == 1 ||
+      parse_ahead_frame != nullptr;
   if (use_intra_prediction_buffer) {
     if (!frame_scratch_buffer->intra_prediction_buffers.Resize(
             frame_header.tile_info.tile_rows)) {
@@ -1475,16 +1816,28 @@ StatusCode DecoderImpl::DecodeTiles(
     }
   }
 
-  SymbolDecoderContext saved_symbol_decoder_context;
+  // The CDF tables saved by the context update tile. Only allocated when they
+  // are needed.
+  std::unique_ptr<SymbolDecoderContext> saved_symbol_decoder_context;
+  if (frame_header.enable_frame_end_update_cdf) {
+    saved_symbol_decoder_context.reset(new (std::nothrow) SymbolDecoderContext);
+    if (saved_symbol_decoder_context == nullptr) {
+      LIBGAV1_DLOG(ERROR, "Failed to allocate symbol decoder context.");
+      return kStatusOutOfMemory;
+    }
+  }
   BlockingCounterWithStatus pending_tiles(tile_count);
   for (int tile_number = 0; tile_number < tile_count; ++tile_number) {
     std::unique_ptr<Tile> tile = Tile::Create(
         tile_number, tile_buffers[tile_number].data,
         tile_buffers[tile_number].size, sequence_header, frame_header,
-        current_frame, state, frame_scratch_buffer, wedge_masks_,
-        quantizer_matrix_, &saved_symbol_decoder_context, prev_segment_ids,
-        &post_filter, dsp, threading_strategy.row_thread_pool(tile_number),
-        &pending_tiles, is_frame_parallel_, use_intra_prediction_buffer);
+        current_frame, state, frame_scratch_buffer, *wedge_masks_,
+        quantizer_matrix_, saved_symbol_decoder_context.get(),
+        prev_segment_ids, post_filter.get(), dsp,
+        threading_strategy.row_thread_pool(tile_number),
+        (parse_ahead_frame != nullptr) ? nullptr : &pending_tiles,
+        is_frame_parallel_ || parse_ahead_frame != nullptr,
+        use_intra_prediction_buffer, settings_.preview_scale_log2);
     if (tile == nullptr) {
       LIBGAV1_DLOG(ERROR, "Failed to create tile.");
       return kStatusOutOfMemory;
@@ -1492,29 +1845,39 @@ StatusCode DecoderImpl::DecodeTiles(
     tiles.push_back_unchecked(std::move(tile));
   }
   assert(tiles.size() == static_cast<size_t>(tile_count));
+  if (parse_ahead_frame != nullptr) {
+    const StatusCode status = ParseFrame(
+        frame_header, tiles, &saved_symbol_decoder_context, prev_segment_ids,
+        frame_scratch_buffer, current_frame);
+    if (status != kStatusOk) return status;
+    parse_ahead_frame->tiles = std::move(tiles);
+    parse_ahead_frame->post_filter = std::move(post_filter);
+    return kStatusOk;
+  }
   if (is_frame_parallel_) {
     if (frame_scratch_buffer->threading_strategy.thread_pool() == nullptr) {
       return DecodeTilesFrameParallel(
-          sequence_header, frame_header, tiles, saved_symbol_decoder_context,
-          prev_segment_ids, frame_scratch_buffer, &post_filter, current_frame);
+          sequence_header, frame_header, tiles, &saved_symbol_decoder_context,
+          prev_segment_ids, frame_scratch_buffer, post_filter.get(),
+          current_frame);
     }
     return DecodeTilesThreadedFrameParallel(
-        sequence_header, frame_header, tiles, saved_symbol_decoder_context,
-        prev_segment_ids, frame_scratch_buffer, &post_filter, current_frame);
+        sequence_header, frame_header, tiles, &saved_symbol_decoder_context,
+        prev_segment_ids, frame_scratch_buffer, post_filter.get(),
+        current_frame);
   }
   StatusCode status;
   if (settings_.threads == 1) {
-    status = DecodeTilesNonFrameParallel(sequence_header, frame_header, tiles,
-                                         frame_scratch_buffer, &post_filter);
+    status =
+        DecodeTilesNonFrameParallel(sequence_header, frame_header, tiles,
+                                    frame_scratch_buffer, post_filter.get());
   } else {
-    status = DecodeTilesThreadedNonFrameParallel(tiles, frame_scratch_buffer,
-                                                 &post_filter, &pending_tiles);
+    status = DecodeTilesThreadedNonFrameParallel(
+        tiles, frame_scratch_buffer, post_filter.get(), &pending_tiles);
   }
   if (status != kStatusOk) return status;
-  if (frame_header.enable_frame_end_update_cdf) {
-    frame_scratch_buffer->symbol_decoder_context = saved_symbol_decoder_context;
-  }
-  current_frame->SetFrameContext(frame_scratch_buffer->symbol_decoder_context);
+  SetFrameContext(frame_header, frame_scratch_buffer->symbol_decoder_context,
+                  &saved_symbol_decoder_context, current_frame);
   SetSegmentationMap(frame_header, prev_segment_ids, current_frame);
   return kStatusOk;
 }
@@ -1526,7 +1889,7 @@ StatusCode DecoderImpl::ApplyFilmGrain(
     RefCountedBufferPtr* film_grain_frame, ThreadPool* thread_pool) {
   if (!sequence_header.film_grain_params_present ||
       !displayable_frame->film_grain_params().apply_grain ||
-      (settings_.post_filter_mask & 0x10) == 0) {
+      (GetPostFilterMask(displayable_frame->frame_type()) & 0x10) == 0) {
     *film_grain_frame = displayable_frame;
     return kStatusOk;
   }
@@ -1621,13 +1984,55 @@ StatusCode DecoderImpl::ApplyFilmGrain(
   return kStatusOk;
 }
 
-bool DecoderImpl::IsNewSequenceHeader(const ObuParser& obu) {
-  if (std::find_if(obu.obu_headers().begin(), obu.obu_headers().end(),
-                   [](const ObuHeader& obu_header) {
-                     return obu_header.type == kObuSequenceHeader;
-                   }) == obu.obu_headers().end()) {
-    return false;
+StatusCode DecoderImpl::DownscaleFrame(const RefCountedBufferPtr& frame,
+                                       RefCountedBufferPtr* preview_frame) {
+  const int scale_log2 = settings_.preview_scale_log2;
+  const YuvBuffer& src = *frame->buffer();
+  // |frame| and |preview_frame| may point to the same RefCountedBufferPtr, so
+  // |preview_frame| is only set at the end.
+  RefCountedBufferPtr downscaled_frame = buffer_pool_.GetFreeBuffer();
+  if (downscaled_frame == nullptr) {
+    LIBGAV1_DLOG(ERROR, "Could not get downscaled_frame from the buffer pool.");
+    return kStatusResourceExhausted;
+  }
+  if (!downscaled_frame->Realloc(
+          src.bitdepth(), src.is_monochrome(),
+          RightShiftWithCeiling(src.width(kPlaneY), scale_log2),
+          RightShiftWithCeiling(src.height(kPlaneY), scale_log2),
+          src.subsampling_x(), src.subsampling_y(), kBorderPixelsFilmGrain,
+          kBorderPixelsFilmGrain, kBorderPixelsFilmGrain,
+          kBorderPixelsFilmGrain)) {
+    LIBGAV1_DLOG(ERROR, "downscaled_frame->Realloc() failed.");
+    return kStatusOutOfMemory;
   }
+  downscaled_frame->set_chroma_sample_position(
+      frame->chroma_sample_position());
+  downscaled_frame->set_spatial_id(frame->spatial_id());
+  downscaled_frame->set_temporal_id(frame->temporal_id());
+  YuvBuffer& dst = *downscaled_frame->buffer();
+  const int num_planes =
+      src.is_monochrome() ? kMaxPlanesMonochrome : kMaxPlanes;
+  for (int plane = kPlaneY; plane < num_planes; ++plane) {
+#if LIBGAV1_MAX_BITDEPTH >= 10
+    if (src.bitdepth() > 8) {
+      DownscalePlane<uint16_t>(src.data(plane), src.stride(plane),
+                               src.width(plane), src.height(plane), scale_log2,
+                               dst.data(plane), dst.stride(plane),
+                               dst.width(plane), dst.height(plane));
+      continue;
+    }
+#endif
+    DownscalePlane<uint8_t>(src.data(plane), src.stride(plane),
+                            src.width(plane), src.height(plane), scale_log2,
+                            dst.data(plane), dst.stride(plane),
+                            dst.width(plane), dst.height(plane));
+  }
+  *preview_frame = std::move(downscaled_frame);
+  return kStatusOk;
+}
+
+bool DecoderImpl::IsNewSequenceHeader(const ObuParser& obu) {
+  if (!HasSequenceHeaderObu(obu)) return false;
   const ObuSequenceHeader sequence_header = obu.sequence_header();
   const bool sequence_header_changed =
       !has_sequence_header_ ||
@@ -1648,14 +2053,11 @@ bool DecoderImpl::IsNewSequenceHeader(const ObuParser& obu) {
 
 bool DecoderImpl::MaybeInitializeQuantizerMatrix(
     const ObuFrameHeader& frame_header) {
-  if (quantizer_matrix_initialized_ || !frame_header.quantizer.use_matrix) {
+  if (quantizer_matrix_ != nullptr || !frame_header.quantizer.use_matrix) {
     return true;
   }
-  if (!InitializeQuantizerMatrix(&quantizer_matrix_)) {
-    return false;
-  }
-  quantizer_matrix_initialized_ = true;
-  return true;
+  quantizer_matrix_ = GetQuantizerMatrix();
+  return quantizer_matrix_ != nullptr;
 }
 
 }  // namespace libgav1
@@ -23,6 +23,7 @@
 #include <cstdint>
 #include <memory>
 #include <mutex>  // NOLINT (unapproved c++11 header)
+#include <utility>
 
 #include "src/buffer_pool.h"
 #include "src/decoder_state.h"
@@ -32,27 +33,42 @@
 #include "src/gav1/decoder_settings.h"
 #include "src/gav1/status_code.h"
 #include "src/obu_parser.h"
+#include "src/post_filter.h"
 #include "src/quantizer.h"
 #include "src/residual_buffer_pool.h"
 #include "src/symbol_decoder_context.h"
 #include "src/tile.h"
 #include "src/utils/array_2d.h"
 #include "src/utils/block_parameters_holder.h"
+#include "src/utils/blocking_counter.h"
 #include "src/utils/compiler_attributes.h"
 #include "src/utils/constants.h"
 #include "src/utils/memory.h"
 #include "src/utils/queue.h"
 #include "src/utils/segmentation_map.h"
+#include "src/utils/threadpool.h"
 #include "src/utils/types.h"
+#include "src/utils/vector.h"
 
 namespace libgav1 {
 
 struct TemporalUnit;
 
+// A sequence header that is shared by all the frames that use it. A new one is
+// created only when a sequence header OBU is seen.
+using SharedSequenceHeader = std::shared_ptr<const ObuSequenceHeader>;
+
+// A frame that has been parsed by ParseAndSchedule() and is waiting to be
+// decoded in frame parallel mode.
+//
+// |tile_buffers| point into the |data| of the TemporalUnit that contains this
+// frame. The tile data is never copied, which is why the caller must keep the
+// input buffer alive until it is released (see Decoder::EnqueueFrame()).
 struct EncodedFrame {
-  EncodedFrame(ObuParser* const obu, const DecoderState& state,
-               const RefCountedBufferPtr& frame, int position_in_temporal_unit)
-      : sequence_header(obu->sequence_header()),
+  EncodedFrame(ObuParser* const obu, SharedSequenceHeader sequence_header,
+               const DecoderState& state, const RefCountedBufferPtr& frame,
+               int position_in_temporal_unit)
+      : sequence_header(std::move(sequence_header)),
         frame_header(obu->frame_header()),
         state(state),
         temporal_unit(nullptr),
@@ -62,7 +78,7 @@ struct EncodedFrame {
     frame->MarkFrameAsStarted();
   }
 
-  const ObuSequenceHeader sequence_header;
+  const SharedSequenceHeader sequence_header;
   const ObuFrameHeader frame_header;
   Vector<TileBuffer> tile_buffers;
   DecoderState state;
@@ -128,6 +144,58 @@ struct TemporalUnit : public Allocable {
   bool released_input_buffer;
 };
 
+// A frame whose tiles have been parsed on the calling thread and which is
+// reconstructed and post filtered on another thread, while the next frame of
+// the temporal unit is parsed. Used only when |DecoderSettings::parse_ahead|
+// is true. The tiles and the post filter keep references to the headers and
+// to the reference frames, so they are copied here (the ObuParser and the
+// decoder state move on to the next frame).
+class ParseAheadFrame : public Allocable {
+ public:
+  ParseAheadFrame(const ObuSequenceHeader& sequence_header,
+                  const ObuFrameHeader& frame_header, const DecoderState& state,
+                  const RefCountedBufferPtr& frame,
+                  FrameScratchBufferPool* frame_scratch_buffer_pool)
+      : sequence_header(sequence_header),
+        frame_header(frame_header),
+        state(state),
+        frame(frame),
+        frame_scratch_buffer_pool_(frame_scratch_buffer_pool) {}
+
+  // Not copyable or movable.
+  ParseAheadFrame(const ParseAheadFrame&) = delete;
+  ParseAheadFrame& operator=(const ParseAheadFrame&) = delete;
+
+  // Waits for the reconstruction if it has been scheduled and not waited for,
+  // and returns |frame_scratch_buffer| to its pool.
+  ~ParseAheadFrame();
+
+  // Schedules the reconstruction of the frame on |thread_pool|. |tiles| must
+  // have been parsed.
+  void Schedule(ThreadPool* thread_pool);
+  // Waits until the reconstruction scheduled by Schedule() is done. Returns
+  // true if it succeeded. Must be called at most once.
+  bool Wait();
+
+  const ObuSequenceHeader sequence_header;
+  const ObuFrameHeader frame_header;
+  const DecoderState state;
+  const RefCountedBufferPtr frame;
+  std::unique_ptr<FrameScratchBuffer> frame_scratch_buffer;
+  std::unique_ptr<PostFilter> post_filter;
+  Vector<std::unique_ptr<Tile>> tiles;
+
+ private:
+  // Decodes the superblocks and applies the post filters. Runs on the thread
+  // pool passed to Schedule().
+  void Reconstruct();
+
+  FrameScratchBufferPool* const frame_scratch_buffer_pool_;
+  BlockingCounterWithStatus reconstructed_{1};
+  bool scheduled_ = false;
+  bool waited_ = false;
+};
+
 class DecoderImpl : public Allocable {
  public:
   // The constructor saves a const reference to |*settings|. Therefore
@@ -190,12 +258,25 @@ class DecoderImpl : public Allocable {
   // Populates |buffer_| with values from |frame|. Adds a reference to |frame|
   // in |output_frame_|.
   StatusCode CopyFrameToOutputBuffer(const RefCountedBufferPtr& frame);
+  // If |parse_ahead_frame| is not nullptr, only parses the tiles and moves
+  // them (along with the post filter) into |parse_ahead_frame| so that the
+  // frame can be reconstructed later. |sequence_header|, |frame_header| and
+  // |state| must then be the copies held by |parse_ahead_frame|.
   StatusCode DecodeTiles(const ObuSequenceHeader& sequence_header,
                          const ObuFrameHeader& frame_header,
                          const Vector<TileBuffer>& tile_buffers,
                          const DecoderState& state,
                          FrameScratchBuffer* frame_scratch_buffer,
-                         RefCountedBuffer* current_frame);
+                         RefCountedBuffer* current_frame,
+                         ParseAheadFrame* parse_ahead_frame);
+  // Used only when |parse_ahead_thread_pool_| is not nullptr. Parses the tiles
+  // of the frame that was just parsed by |obu| and schedules its
+  // reconstruction on |parse_ahead_thread_pool_|. If |parse_ahead_frames| is
+  // full, waits for the oldest frame in it first.
+  StatusCode ParseAhead(const ObuParser& obu,
+                        const RefCountedBufferPtr& current_frame,
+                        Queue<std::unique_ptr<ParseAheadFrame>>*
+                            parse_ahead_frames);
   // Applies film grain synthesis to the |displayable_frame| and stores the film
   // grain applied frame into |film_grain_frame|. Returns kStatusOk on success.
   StatusCode ApplyFilmGrain(const ObuSequenceHeader& sequence_header,
@@ -204,6 +285,12 @@ class DecoderImpl : public Allocable {
                             RefCountedBufferPtr* film_grain_frame,
                             ThreadPool* thread_pool);
 
+  // Downscales |frame| by (1 << |settings_.preview_scale_log2|) in each
+  // dimension and stores the result into |preview_frame|. Returns kStatusOk on
+  // success.
+  StatusCode DownscaleFrame(const RefCountedBufferPtr& frame,
+                            RefCountedBufferPtr* preview_frame);
+
   bool IsNewSequenceHeader(const ObuParser& obu);
 
   bool HasFailure() {
@@ -211,8 +298,23 @@ class DecoderImpl : public Allocable {
     return failure_status_ != kStatusOk;
   }
 
-  // Initializes the |quantizer_matrix_| if necessary and sets
-  // |quantizer_matrix_initialized_| to true.
+  // Returns the mask of the post filters that may be applied to a frame of
+  // type |frame_type|.
+  uint8_t GetPostFilterMask(FrameType frame_type) const {
+    return IsIntraFrame(frame_type)
+               ? settings_.post_filter_mask
+               : settings_.post_filter_mask & settings_.inter_post_filter_mask;
+  }
+
+  // Returns true if |frame| is neither decoded nor output because
+  // |settings_.key_frames_only| is true. For a show existing frame header,
+  // |frame| is the reference frame being shown.
+  bool SkipFrame(const RefCountedBuffer& frame) const {
+    return settings_.key_frames_only && frame.frame_type() != kFrameKey;
+  }
+
+  // Sets |quantizer_matrix_| to the shared quantizer matrix if it is needed by
+  // |frame_header| and has not been set yet.
   bool MaybeInitializeQuantizerMatrix(const ObuFrameHeader& frame_header);
 
   // Elements in this queue cannot be moved with std::move since the
@@ -232,9 +334,10 @@ class DecoderImpl : public Allocable {
   Queue<RefCountedBufferPtr> output_frame_queue_;
 
   BufferPool buffer_pool_;
-  WedgeMaskArray wedge_masks_;
-  QuantizerMatrix quantizer_matrix_;
-  bool quantizer_matrix_initialized_ = false;
+  // These tables are shared by all the decoder instances in the process. See
+  // GetWedgeMasks() and GetQuantizerMatrix().
+  const WedgeMaskArray* wedge_masks_ = nullptr;
+  const QuantizerMatrix* quantizer_matrix_ = nullptr;
   FrameScratchBufferPool frame_scratch_buffer_pool_;
 
   // Used to synchronize the accesses into |temporal_units_| in order to update
@@ -243,6 +346,21 @@ class DecoderImpl : public Allocable {
   std::condition_variable decoded_condvar_;
   bool is_frame_parallel_;
   std::unique_ptr<ThreadPool> frame_thread_pool_;
+  // Runs the jobs using |settings_.schedule_job|. Set when
+  // |settings_.schedule_job| is not nullptr and |settings_.threads| > 1.
+  std::unique_ptr<ThreadPool> external_thread_pool_;
+  // Either |external_thread_pool_| or the process-wide thread pool (see
+  // GetSharedThreadPool()). If not nullptr, it is used for all the frames
+  // instead of the thread pools owned by the frame scratch buffers.
+  ThreadPool* shared_thread_pool_ = nullptr;
+  // Reconstructs the frames that are parsed ahead. Created with a single
+  // thread (so the frames are reconstructed in decoding order) when
+  // |settings_.parse_ahead| is true and frame parallel mode is not used.
+  std::unique_ptr<ThreadPool> parse_ahead_thread_pool_;
+  // The frame scratch buffers of the frames that are parsed ahead. They are
+  // kept apart from |frame_scratch_buffer_pool_| because their threading
+  // strategy is never reset, so that these frames use no worker threads.
+  FrameScratchBufferPool parse_ahead_frame_scratch_buffer_pool_;
 
   // In frame parallel mode, there are two primary points of failure:
   //  1) ParseAndSchedule()
@@ -256,6 +374,9 @@ class DecoderImpl : public Allocable {
   ObuSequenceHeader sequence_header_ = {};
   // If true, sequence_header is valid.
   bool has_sequence_header_ = false;
+  // Used only in frame parallel mode. The sequence header of the most recently
+  // parsed frame, shared with the EncodedFrames that use it.
+  SharedSequenceHeader shared_sequence_header_;
 
   const DecoderSettings& settings_;
   bool seen_first_frame_ = false;
@@ -28,6 +28,14 @@ void Libgav1DecoderSettingsInitDefault(Libgav1DecoderSettings* settings) {
   settings->output_all_layers = 0;  // false
   settings->operating_point = 0;
   settings->post_filter_mask = 0x1f;
+  settings->key_frames_only = 0;  // false
+  settings->inter_post_filter_mask = 0x1f;
+  settings->preview_scale_log2 = 0;
+  settings->shared_thread_pool = 0;  // false
+  settings->schedule_job = nullptr;
+  settings->interleave_numa_nodes = 0;  // false
+  settings->use_huge_pages = 0;         // false
+  settings->parse_ahead = 0;            // false
 }
 
 }  // extern "C"
@@ -685,14 +685,25 @@ LIBGAV1_ALWAYS_INLINE void Dct16Stages(int16x8_t* s) {
   HadamardRotation(&s[7], &s[8], false);
 }
 
-// Process dct16 rows or columns, depending on the transpose flag.
-template <ButterflyRotationFunc butterfly_rotation, bool stage_is_rectangular>
+// Process dct16 rows or columns, depending on the transpose flag. If
+// |is_fast_butterfly| is true, only the first 8 inputs may be non-zero.
+template <ButterflyRotationFunc butterfly_rotation, bool stage_is_rectangular,
+          bool is_fast_butterfly = false>
 LIBGAV1_ALWAYS_INLINE void Dct16_NEON(void* dest, int32_t step, bool is_row,
                                       int row_shift) {
+  static_assert(!is_fast_butterfly || !stage_is_rectangular, "");
   auto* const dst = static_cast<int16_t*>(dest);
   int16x8_t s[16], x[16];
 
-  if (stage_is_rectangular) {
+  if (is_fast_butterfly) {
+    LoadSrc<16, 8>(dst, step, 0, x);
+    if (is_row) {
+      dsp::Transpose8x8(x);
+    }
+    for (int i = 8; i < 16; ++i) {
+      x[i] = vdupq_n_s16(0);
+    }
+  } else if (stage_is_rectangular) {
     if (is_row) {
       int16x8_t input[4];
       LoadSrc<16, 4>(dst, step, 0, input);
@@ -730,9 +741,9 @@ LIBGAV1_ALWAYS_INLINE void Dct16_NEON(void* dest, int32_t step, bool is_row,
   s[14] = x[7];
   s[15] = x[15];
 
-  Dct4Stages<butterfly_rotation>(s);
-  Dct8Stages<butterfly_rotation>(s);
-  Dct16Stages<butterfly_rotation>(s);
+  Dct4Stages<butterfly_rotation, is_fast_butterfly>(s);
+  Dct8Stages<butterfly_rotation, is_fast_butterfly>(s);
+  Dct16Stages<butterfly_rotation, is_fast_butterfly>(s);
 
   if (is_row) {
     const int16x8_t v_row_shift = vdupq_n_s16(-row_shift);
@@ -851,20 +862,28 @@ LIBGAV1_ALWAYS_INLINE void Dct32Stages(int16x8_t* s) {
   HadamardRotation(&s[15], &s[16], false);
 }
 
-// Process dct32 rows or columns, depending on the transpose flag.
+// Process dct32 rows or columns, depending on the transpose flag. If
+// |is_fast_butterfly| is true, only the first 16 inputs may be non-zero.
+template <bool is_fast_butterfly = false>
 LIBGAV1_ALWAYS_INLINE void Dct32_NEON(void* dest, const int32_t step,
                                       const bool is_row, int row_shift) {
   auto* const dst = static_cast<int16_t*>(dest);
   int16x8_t s[32], x[32];
+  const int num_inputs = is_fast_butterfly ? 16 : 32;
 
   if (is_row) {
-    for (int idx = 0; idx < 32; idx += 8) {
+    for (int idx = 0; idx < num_inputs; idx += 8) {
       LoadSrc<16, 8>(dst, step, idx, &x[idx]);
       dsp::Transpose8x8(&x[idx]);
     }
+  } else if (is_fast_butterfly) {
+    LoadSrc<16, 16>(dst, step, 0, x);
   } else {
     LoadSrc<16, 32>(dst, step, 0, x);
   }
+  for (int i = num_inputs; i < 32; ++i) {
+    x[i] = vdupq_n_s16(0);
+  }
 
   // stage 1
   // kBitReverseLookup
@@ -904,10 +923,10 @@ LIBGAV1_ALWAYS_INLINE void Dct32_NEON(void* dest, const int32_t step,
   s[30] = x[15];
   s[31] = x[31];
 
-  Dct4Stages<ButterflyRotation_8>(s);
-  Dct8Stages<ButterflyRotation_8>(s);
-  Dct16Stages<ButterflyRotation_8>(s);
-  Dct32Stages<ButterflyRotation_8>(s);
+  Dct4Stages<ButterflyRotation_8, is_fast_butterfly>(s);
+  Dct8Stages<ButterflyRotation_8, is_fast_butterfly>(s);
+  Dct16Stages<ButterflyRotation_8, is_fast_butterfly>(s);
+  Dct32Stages<ButterflyRotation_8, is_fast_butterfly>(s);
 
   if (is_row) {
     const int16x8_t v_row_shift = vdupq_n_s16(-row_shift);
@@ -3044,6 +3063,146 @@ void Wht4TransformLoopColumn_NEON(TransformType tx_type, TransformSize tx_size,
   Wht4_NEON(dst, dst_stride, src, adjusted_tx_height);
 }
 
+//------------------------------------------------------------------------------
+// Dct-Dct sub-region transforms.
+
+// Adds the constant |residual_value| to the |tx_width|x|tx_height| block at
+// (|start_x|, |start_y|). One of |v_add| and |v_sub| is always zero, so the
+// saturating byte operations give Clip3(pixel + residual_value, 0, 255).
+template <int tx_height>
+LIBGAV1_ALWAYS_INLINE void AddDcToFrame(Array2DView<uint8_t> frame,
+                                        const int start_x, const int start_y,
+                                        const int tx_width,
+                                        const int residual_value) {
+  const uint8x16_t v_add = vdupq_n_u8(Clip3(residual_value, 0, 255));
+  const uint8x16_t v_sub = vdupq_n_u8(Clip3(-residual_value, 0, 255));
+  const int stride = frame.columns();
+  uint8_t* dst = frame[start_y] + start_x;
+  if (tx_width == 4) {
+    uint8x8_t frame_data = vdup_n_u8(0);
+    for (int i = 0; i < tx_height; ++i) {
+      frame_data = Load4<0>(dst, frame_data);
+      const uint8x8_t a = vqadd_u8(frame_data, vget_low_u8(v_add));
+      StoreLo4(dst, vqsub_u8(a, vget_low_u8(v_sub)));
+      dst += stride;
+    }
+  } else if (tx_width == 8) {
+    for (int i = 0; i < tx_height; ++i) {
+      const uint8x8_t a = vqadd_u8(vld1_u8(dst), vget_low_u8(v_add));
+      vst1_u8(dst, vqsub_u8(a, vget_low_u8(v_sub)));
+      dst += stride;
+    }
+  } else {
+    for (int i = 0; i < tx_height; ++i) {
+      int j = 0;
+      do {
+        const uint8x16_t a = vqaddq_u8(vld1q_u8(&dst[j]), v_add);
+        vst1q_u8(&dst[j], vqsubq_u8(a, v_sub));
+        j += 16;
+      } while (j < tx_width);
+      dst += stride;
+    }
+  }
+}
+
+// The row transform, column transform and rounding mirror DctDcOnly(),
+// DctDcOnlyColumn() and StoreToFrameWithRound() for a single value, since every
+// position of a DC-only block receives the same residual.
+template <int tx_height>
+void DctDcOnlyTransformAdd_NEON(TransformSize tx_size, void* src_buffer,
+                                int start_x, int start_y, void* dst_frame) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  const int16x4_t v_src = vdup_n_s16(src[0]);
+  const int16x4_t v_src_round =
+      vqrdmulh_n_s16(v_src, kTransformRowMultiplier << 3);
+  const int16x4_t s0 = should_round ? v_src_round : v_src;
+  const int16_t cos128 = Cos128(32);
+  const int16x4_t xy = vqrdmulh_n_s16(s0, cos128 << 3);
+  // vqrshl_s16 will shift right if shift value is negative.
+  const int16x4_t row = vqrshl_s16(xy, vdup_n_s16(-row_shift));
+  const int16x4_t column = vqrdmulh_n_s16(row, cos128 << 3);
+  const int16x4_t residual = vrshr_n_s16(column, 4);
+
+  auto& frame = *static_cast<Array2DView<uint8_t>*>(dst_frame);
+  AddDcToFrame<tx_height>(frame, start_x, start_y, tx_width,
+                          vget_lane_s16(residual, 0));
+}
+
+// Row transforms for the sub-region transforms. Only the first |num_rows| rows
+// are processed and at most half of the inputs of each row are non-zero.
+template <int tx_width>
+LIBGAV1_ALWAYS_INLINE void DctSubRegionRows(int16_t* src, int num_rows,
+                                            bool should_round,
+                                            uint8_t row_shift) {
+  if (should_round) {
+    ApplyRounding<tx_width>(src, num_rows);
+  }
+  // Process 8 1d dct rows in parallel per iteration.
+  int i = 0;
+  do {
+    if (tx_width == 16) {
+      Dct16_NEON<ButterflyRotation_8, false, /*is_fast_butterfly=*/true>(
+          &src[i * 16], 16, /*is_row=*/true, row_shift);
+    } else if (tx_width == 32) {
+      Dct32_NEON</*is_fast_butterfly=*/true>(&src[i * 32], 32,
+                                             /*is_row=*/true, row_shift);
+    } else {
+      // Dct64_NEON() always assumes the last 32 inputs are zero.
+      Dct64_NEON(&src[i * 64], 64, /*is_row=*/true, row_shift);
+    }
+    i += 8;
+  } while (i < num_rows);
+}
+
+// Applies the Dct-Dct transform to a block whose non-zero coefficients lie in
+// the top-left |sub_region_size|x|sub_region_size| region. Only the first
+// |sub_region_size| rows need the row transform and, since at most half of
+// the inputs of every row and column are non-zero, all the first stage
+// butterfly rotations have a zero input.
+template <int tx_height, int sub_region_size>
+void DctSubRegionTransformAdd_NEON(TransformSize tx_size, void* src_buffer,
+                                   int start_x, int start_y, void* dst_frame) {
+  static_assert(2 * sub_region_size <= tx_height, "");
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+  assert(2 * sub_region_size <= tx_width);
+
+  if (tx_width == 16) {
+    DctSubRegionRows<16>(src, sub_region_size, should_round, row_shift);
+  } else if (tx_width == 32) {
+    DctSubRegionRows<32>(src, sub_region_size, should_round, row_shift);
+  } else {
+    assert(tx_width == 64);
+    DctSubRegionRows<64>(src, sub_region_size, should_round, row_shift);
+  }
+
+  // Process 8 1d dct columns in parallel per iteration.
+  int i = tx_width;
+  auto* data = src;
+  do {
+    if (tx_height == 16) {
+      Dct16_NEON<ButterflyRotation_8, false, /*is_fast_butterfly=*/true>(
+          data, tx_width, /*is_row=*/false, /*row_shift=*/0);
+    } else if (tx_height == 32) {
+      Dct32_NEON</*is_fast_butterfly=*/true>(data, tx_width, /*is_row=*/false,
+                                             /*row_shift=*/0);
+    } else {
+      Dct64_NEON(data, tx_width, /*is_row=*/false, /*row_shift=*/0);
+    }
+    data += 8;
+    i -= 8;
+  } while (i != 0);
+  auto& frame = *static_cast<Array2DView<uint8_t>*>(dst_frame);
+  StoreToFrameWithRound<tx_height>(frame, start_x, start_y, tx_width, src,
+                                   kTransformTypeDctDct);
+}
+
 //------------------------------------------------------------------------------
 
 void Init8bpp() {
@@ -3108,6 +3267,39 @@ void Init8bpp() {
       Wht4TransformLoopRow_NEON;
   dsp->inverse_transforms[k1DTransformWht][k1DTransformSize4][kColumn] =
       Wht4TransformLoopColumn_NEON;
+
+  // Dct-Dct sub-region transforms. The sub-regions are only used for
+  // transforms with at least twice the sub-region size in each dimension.
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize4] =
+      DctDcOnlyTransformAdd_NEON<4>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize8] =
+      DctDcOnlyTransformAdd_NEON<8>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize16] =
+      DctDcOnlyTransformAdd_NEON<16>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize32] =
+      DctDcOnlyTransformAdd_NEON<32>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize64] =
+      DctDcOnlyTransformAdd_NEON<64>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion8x8]
+                                        [k1DTransformSize16] =
+      DctSubRegionTransformAdd_NEON<16, 8>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion8x8]
+                                        [k1DTransformSize32] =
+      DctSubRegionTransformAdd_NEON<32, 8>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion8x8]
+                                        [k1DTransformSize64] =
+      DctSubRegionTransformAdd_NEON<64, 8>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion16x16]
+                                        [k1DTransformSize32] =
+      DctSubRegionTransformAdd_NEON<32, 16>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion16x16]
+                                        [k1DTransformSize64] =
+      DctSubRegionTransformAdd_NEON<64, 16>;
 }
 
 }  // namespace
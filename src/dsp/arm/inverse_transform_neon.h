@@ -23,7 +23,8 @@
 namespace libgav1 {
 namespace dsp {
 
-// Initializes Dsp::inverse_transforms, see the defines below for specifics.
+// Initializes Dsp::inverse_transforms and
+// Dsp::inverse_transforms_dct_sub_region, see the defines below for specifics.
 // This function is not thread-safe.
 void InverseTransformInit_NEON();
 
@@ -47,6 +48,9 @@ void InverseTransformInit_NEON();
 #define LIBGAV1_Dsp8bpp_1DTransformSize32_1DTransformIdentity LIBGAV1_CPU_NEON
 
 #define LIBGAV1_Dsp8bpp_1DTransformSize4_1DTransformWht LIBGAV1_CPU_NEON
+
+#define LIBGAV1_Dsp8bpp_InverseTransformDctDcOnly LIBGAV1_CPU_NEON
+#define LIBGAV1_Dsp8bpp_InverseTransformDctSubRegion LIBGAV1_CPU_NEON
 #endif  // LIBGAV1_ENABLE_NEON
 
 #endif  // LIBGAV1_SRC_DSP_ARM_INVERSE_TRANSFORM_NEON_H_
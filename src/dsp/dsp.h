@@ -69,6 +69,15 @@ enum TransformSize1D : uint8_t {
   kNum1DTransformSizes
 };
 
+// Top-left sub-regions of a transform block that may contain all of its
+// non-zero coefficients. Used to select the reduced Dct-Dct inverse transforms.
+enum TransformSubRegion : uint8_t {
+  kTransformSubRegionDcOnly,  // Only the DC coefficient is non-zero.
+  kTransformSubRegion8x8,
+  kTransformSubRegion16x16,
+  kNumTransformSubRegions
+};
+
 // The maximum width of the loop filter, fewer pixels may be filtered depending
 // on strength thresholds.
 enum LoopFilterSize : uint8_t {
@@ -154,6 +163,20 @@ inline const char* ToString(const TransformSize1D transform_size) {
   abort();
 }
 
+inline const char* ToString(const TransformSubRegion sub_region) {
+  switch (sub_region) {
+    case kTransformSubRegionDcOnly:
+      return "kTransformSubRegionDcOnly";
+    case kTransformSubRegion8x8:
+      return "kTransformSubRegion8x8";
+    case kTransformSubRegion16x16:
+      return "kTransformSubRegion16x16";
+    case kNumTransformSubRegions:
+      return "kNumTransformSubRegions";
+  }
+  abort();
+}
+
 inline const char* ToString(const LoopFilterSize filter_size) {
   switch (filter_size) {
     case kLoopFilterSize4:
@@ -255,6 +278,19 @@ using FilterIntraPredictorFunc = void (*)(void* dst, ptrdiff_t stride,
                                           FilterIntraPredictor pred, int width,
                                           int height);
 
+// Palette predictor function signature. Section 7.11.4.
+// |dst| is an unaligned pointer to the output block. Pixel size is determined
+// by bitdepth with |stride| given in bytes. |color_index_map| points to the
+// color index of the top-left pixel of the block, with |color_index_map_stride|
+// bytes between rows. Each index is less than kMaxPaletteSize. |palette| holds
+// kMaxPaletteSize colors. |width| and |height| are the size of the block in
+// pixels.
+using PalettePredictorFunc = void (*)(void* dst, ptrdiff_t stride,
+                                      const uint8_t* color_index_map,
+                                      ptrdiff_t color_index_map_stride,
+                                      const uint16_t* palette, int width,
+                                      int height);
+
 //------------------------------------------------------------------------------
 // Chroma from Luma (Cfl) prediction. Section 7.11.5.
 
@@ -318,6 +354,27 @@ using InverseTransformAddFunc = void (*)(TransformType tx_type,
 using InverseTransformAddFuncs =
     InverseTransformAddFunc[kNum1DTransforms][kNum1DTransformSizes][2];
 
+// Dct-Dct inverse transform add function signature for blocks whose non-zero
+// coefficients all lie in a top-left sub-region of the block.
+//
+// Applies both the row and the column transforms and adds the residual to the
+// destination frame. The parameters have the same meaning as for
+// InverseTransformAddFunc. Only the coefficients inside the sub-region the
+// function is registered for are read from |src_buffer|; the remaining ones
+// must be zero. This allows the implementations to skip most of the column
+// work for large transforms and, for DC-only blocks, to add a single constant
+// to the destination.
+using InverseTransformDctAddFunc = void (*)(TransformSize tx_size,
+                                            void* src_buffer, int start_x,
+                                            int start_y, void* dst_frame);
+// Indexed by TransformSubRegion and the 1D transform size of the columns
+// (i.e., the transform height). kTransformSubRegion8x8 is only used when both
+// dimensions of the transform are at least 16 and kTransformSubRegion16x16
+// when both are at least 32. A nullptr entry means the generic
+// InverseTransformAddFuncs must be used.
+using InverseTransformDctAddFuncs =
+    InverseTransformDctAddFunc[kNumTransformSubRegions][kNum1DTransformSizes];
+
 //------------------------------------------------------------------------------
 // Post processing.
 
@@ -838,6 +895,7 @@ struct Dsp {
   IntraEdgeUpsamplerFunc intra_edge_upsampler;
   IntraPredictorFuncs intra_predictors;
   InverseTransformAddFuncs inverse_transforms;
+  InverseTransformDctAddFuncs inverse_transforms_dct_sub_region;
   LoopFilterFuncs loop_filters;
   LoopRestorationFuncs loop_restorations;
   MaskBlendFuncs mask_blend;
@@ -845,6 +903,7 @@ struct Dsp {
   MvProjectionCompoundFunc mv_projection_compound[3];
   MvProjectionSingleFunc mv_projection_single[3];
   ObmcBlendFuncs obmc_blend;
+  PalettePredictorFunc palette_predictor;
   SuperResCoefficientsFunc super_res_coefficients;
   SuperResFunc super_res;
   WarpCompoundFunc warp_compound;
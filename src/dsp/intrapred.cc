@@ -429,6 +429,28 @@ void FilterIntraPredictor_C(void* const dest, ptrdiff_t stride,
   } while (y < height);
 }
 
+//------------------------------------------------------------------------------
+// PalettePredictor_C
+
+template <typename Pixel>
+void PalettePredictor_C(void* const dest, ptrdiff_t stride,
+                        const uint8_t* color_index_map,
+                        const ptrdiff_t color_index_map_stride,
+                        const uint16_t* const palette, const int width,
+                        const int height) {
+  auto* dst = static_cast<Pixel*>(dest);
+  stride /= sizeof(Pixel);
+  int y = 0;
+  do {
+    for (int x = 0; x < width; ++x) {
+      assert(color_index_map[x] < kMaxPaletteSize);
+      dst[x] = palette[color_index_map[x]];
+    }
+    dst += stride;
+    color_index_map += color_index_map_stride;
+  } while (++y < height);
+}
+
 //------------------------------------------------------------------------------
 // CflIntraPredictor_C
 
@@ -787,6 +809,7 @@ void Init8bpp() {
   dsp->directional_intra_predictor_zone3 =
       DirectionalIntraPredictorZone3_C<uint8_t>;
   dsp->filter_intra_predictor = FilterIntraPredictor_C<8, uint8_t>;
+  dsp->palette_predictor = PalettePredictor_C<uint8_t>;
   INIT_CFL_INTRAPREDICTORS(8, uint8_t);
 #else  // !LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS
 #ifndef LIBGAV1_Dsp8bpp_TransformSize4x4_IntraPredictorDcFill
@@ -1581,6 +1604,10 @@ void Init8bpp() {
   dsp->filter_intra_predictor = FilterIntraPredictor_C<8, uint8_t>;
 #endif
 
+#ifndef LIBGAV1_Dsp8bpp_PalettePredictor
+  dsp->palette_predictor = PalettePredictor_C<uint8_t>;
+#endif
+
 #ifndef LIBGAV1_Dsp8bpp_TransformSize4x4_CflIntraPredictor
   dsp->cfl_intra_predictors[kTransformSize4x4] =
       CflIntraPredictor_C<4, 4, 8, uint8_t>;
@@ -1845,6 +1872,7 @@ void Init10bpp() {
   dsp->directional_intra_predictor_zone3 =
       DirectionalIntraPredictorZone3_C<uint16_t>;
   dsp->filter_intra_predictor = FilterIntraPredictor_C<10, uint16_t>;
+  dsp->palette_predictor = PalettePredictor_C<uint16_t>;
   INIT_CFL_INTRAPREDICTORS(10, uint16_t);
 #else  // !LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS
 #ifndef LIBGAV1_Dsp10bpp_TransformSize4x4_IntraPredictorDcFill
@@ -2643,6 +2671,10 @@ void Init10bpp() {
   dsp->filter_intra_predictor = FilterIntraPredictor_C<10, uint16_t>;
 #endif
 
+#ifndef LIBGAV1_Dsp10bpp_PalettePredictor
+  dsp->palette_predictor = PalettePredictor_C<uint16_t>;
+#endif
+
 #ifndef LIBGAV1_Dsp10bpp_TransformSize4x4_CflIntraPredictor
   dsp->cfl_intra_predictors[kTransformSize4x4] =
       CflIntraPredictor_C<4, 4, 10, uint16_t>;
@@ -30,6 +30,7 @@
 // The order of includes is important as each tests for a superior version
 // before setting the base.
 // clang-format off
+#include "src/dsp/x86/intrapred_avx2.h"
 #include "src/dsp/x86/intrapred_sse4.h"
 // clang-format on
 
@@ -39,8 +40,9 @@ namespace libgav1 {
 namespace dsp {
 
 // Initializes Dsp::intra_predictors, Dsp::directional_intra_predictor_zone*,
-// Dsp::cfl_intra_predictors, Dsp::cfl_subsamplers and
-// Dsp::filter_intra_predictor. This function is not thread-safe.
+// Dsp::cfl_intra_predictors, Dsp::cfl_subsamplers,
+// Dsp::filter_intra_predictor and Dsp::palette_predictor. This function is not
+// thread-safe.
 void IntraPredInit_C();
 
 }  // namespace dsp
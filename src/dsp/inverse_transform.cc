@@ -1209,6 +1209,40 @@ void TransformLoop_C(TransformType tx_type, TransformSize tx_size,
   }
 }
 
+// The row and column transforms of a Dct-Dct block with only a DC coefficient
+// produce the same value at every position, so the 1D transforms are computed
+// once and the result is added to the whole block.
+template <int bitdepth, typename Residual, typename Pixel>
+void DctDcOnlyTransformAdd_C(TransformSize tx_size, void* src_buffer,
+                             int start_x, int start_y, void* dst_frame) {
+  const int tx_width = kTransformWidth[tx_size];
+  const int tx_height = kTransformHeight[tx_size];
+  const bool should_round =
+      std::abs(kTransformWidthLog2[tx_size] - kTransformHeightLog2[tx_size]) ==
+      1;
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+  const int8_t row_clamp_range = bitdepth + 8;
+  const int8_t column_clamp_range = std::max(bitdepth + 6, 16);
+  auto* const src = static_cast<Residual*>(src_buffer);
+  auto* frame = static_cast<Array2DView<Pixel>*>(dst_frame);
+
+  Residual dc[4] = {src[0]};
+  DctDcOnly_C<bitdepth, Residual, 2>(dc, row_clamp_range, should_round,
+                                     row_shift, /*is_row=*/true);
+  DctDcOnly_C<bitdepth, Residual, 2>(dc, column_clamp_range,
+                                     /*should_round=*/false, /*row_shift=*/0,
+                                     /*is_row=*/false);
+  const int residual_value =
+      RightShiftWithRounding(dc[0], kTransformColumnShift);
+  const int max_value = (1 << bitdepth) - 1;
+  for (int i = 0; i < tx_height; ++i) {
+    Pixel* const dst = &(*frame)[start_y + i][start_x];
+    for (int j = 0; j < tx_width; ++j) {
+      dst[j] = Clip3(dst[j] + residual_value, 0, max_value);
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 
 template <int bitdepth, typename Residual, typename Pixel>
@@ -1324,6 +1358,13 @@ void InitAll(Dsp* const dsp) {
       TransformLoop_C<bitdepth, Residual, Pixel, k1DTransformWht,
                       Wht4DcOnly_C<bitdepth, Residual>, Wht4_C<Residual>,
                       /*is_row=*/false>;
+
+  // The reduced Dct-Dct transforms for the 8x8 and 16x16 sub-regions are only
+  // provided by the SIMD implementations.
+  for (auto& inverse_transform : dsp->inverse_transforms_dct_sub_region
+                                     [kTransformSubRegionDcOnly]) {
+    inverse_transform = DctDcOnlyTransformAdd_C<bitdepth, Residual, Pixel>;
+  }
 }
 
 void Init8bpp() {
@@ -1335,6 +1376,12 @@ void Init8bpp() {
       inverse_transform[kColumn] = nullptr;
     }
   }
+  for (auto& inverse_transform_by_size :
+       dsp->inverse_transforms_dct_sub_region) {
+    for (auto& inverse_transform : inverse_transform_by_size) {
+      inverse_transform = nullptr;
+    }
+  }
 #if LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS
   InitAll<8, int16_t, uint8_t>(dsp);
 #else  // !LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS
@@ -1468,6 +1515,12 @@ void Init8bpp() {
                       Wht4DcOnly_C<8, int16_t>, Wht4_C<int16_t>,
                       /*is_row=*/false>;
 #endif
+#ifndef LIBGAV1_Dsp8bpp_InverseTransformDctDcOnly
+  for (auto& inverse_transform : dsp->inverse_transforms_dct_sub_region
+                                     [kTransformSubRegionDcOnly]) {
+    inverse_transform = DctDcOnlyTransformAdd_C<8, int16_t, uint8_t>;
+  }
+#endif
 #endif  // LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS
 }
 
@@ -1481,6 +1534,12 @@ void Init10bpp() {
       inverse_transform[kColumn] = nullptr;
     }
   }
+  for (auto& inverse_transform_by_size :
+       dsp->inverse_transforms_dct_sub_region) {
+    for (auto& inverse_transform : inverse_transform_by_size) {
+      inverse_transform = nullptr;
+    }
+  }
 #if LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS
   InitAll<10, int32_t, uint16_t>(dsp);
 #else  // !LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS
@@ -1614,6 +1673,12 @@ void Init10bpp() {
                       Wht4DcOnly_C<10, int32_t>, Wht4_C<int32_t>,
                       /*is_row=*/false>;
 #endif
+#ifndef LIBGAV1_Dsp10bpp_InverseTransformDctDcOnly
+  for (auto& inverse_transform : dsp->inverse_transforms_dct_sub_region
+                                     [kTransformSubRegionDcOnly]) {
+    inverse_transform = DctDcOnlyTransformAdd_C<10, int32_t, uint16_t>;
+  }
+#endif
 #endif  // LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS
 }
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
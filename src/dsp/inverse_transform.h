@@ -38,7 +38,8 @@
 namespace libgav1 {
 namespace dsp {
 
-// Initializes Dsp::inverse_transforms. This function is not thread-safe.
+// Initializes Dsp::inverse_transforms and
+// Dsp::inverse_transforms_dct_sub_region. This function is not thread-safe.
 void InverseTransformInit_C();
 
 }  // namespace dsp
@@ -69,9 +69,13 @@ list(APPEND libgav1_dsp_sources_avx2
             ${libgav1_dsp_sources_avx2}
             "${libgav1_source}/dsp/x86/convolve_avx2.cc"
             "${libgav1_source}/dsp/x86/convolve_avx2.h"
+            "${libgav1_source}/dsp/x86/intrapred_avx2.cc"
+            "${libgav1_source}/dsp/x86/intrapred_avx2.h"
             "${libgav1_source}/dsp/x86/loop_restoration_10bit_avx2.cc"
             "${libgav1_source}/dsp/x86/loop_restoration_avx2.cc"
-            "${libgav1_source}/dsp/x86/loop_restoration_avx2.h")
+            "${libgav1_source}/dsp/x86/loop_restoration_avx2.h"
+            "${libgav1_source}/dsp/x86/warp_avx2.cc"
+            "${libgav1_source}/dsp/x86/warp_avx2.h")
 
 list(APPEND libgav1_dsp_sources_neon
             ${libgav1_dsp_sources_neon}
@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 
@@ -31,6 +32,73 @@
 
 namespace libgav1 {
 namespace dsp {
+namespace {
+
+template <int row_bytes>
+inline void CopyRows(const uint8_t* src, const ptrdiff_t src_stride,
+                     const int height, uint8_t* dst,
+                     const ptrdiff_t dst_stride) {
+  int y = height;
+  do {
+    if (row_bytes == 2) {
+      memcpy(dst, src, 2);
+    } else if (row_bytes == 4) {
+      Store4(dst, Load4(src));
+    } else if (row_bytes == 8) {
+      StoreLo8(dst, LoadLo8(src));
+    } else {
+      for (int x = 0; x < row_bytes; x += 16) {
+        StoreUnaligned16(dst + x, LoadUnaligned16(src + x));
+      }
+    }
+    src += src_stride;
+    dst += dst_stride;
+  } while (--y != 0);
+}
+
+// Intra block copy with a whole pixel motion vector copies the block from the
+// current frame. The rows are copied with fixed size loads and stores instead
+// of a memcpy() of |width| pixels per row.
+template <typename Pixel>
+void ConvolveIntraBlockCopy_SSE4_1(
+    const void* const reference, const ptrdiff_t reference_stride,
+    const int /*horizontal_filter_index*/, const int /*vertical_filter_index*/,
+    const int /*horizontal_filter_id*/, const int /*vertical_filter_id*/,
+    const int width, const int height, void* const prediction,
+    const ptrdiff_t pred_stride) {
+  const auto* const src = static_cast<const uint8_t*>(reference);
+  auto* const dest = static_cast<uint8_t*>(prediction);
+  switch (width * sizeof(Pixel)) {
+    case 2:
+      CopyRows<2>(src, reference_stride, height, dest, pred_stride);
+      break;
+    case 4:
+      CopyRows<4>(src, reference_stride, height, dest, pred_stride);
+      break;
+    case 8:
+      CopyRows<8>(src, reference_stride, height, dest, pred_stride);
+      break;
+    case 16:
+      CopyRows<16>(src, reference_stride, height, dest, pred_stride);
+      break;
+    case 32:
+      CopyRows<32>(src, reference_stride, height, dest, pred_stride);
+      break;
+    case 64:
+      CopyRows<64>(src, reference_stride, height, dest, pred_stride);
+      break;
+    case 128:
+      CopyRows<128>(src, reference_stride, height, dest, pred_stride);
+      break;
+    default:
+      assert(width * sizeof(Pixel) == 256);
+      CopyRows<256>(src, reference_stride, height, dest, pred_stride);
+      break;
+  }
+}
+
+}  // namespace
+
 namespace low_bitdepth {
 namespace {
 
@@ -2803,6 +2871,9 @@ void Init8bpp() {
   dsp->convolve[0][1][1][0] = ConvolveCompoundVertical_SSE4_1;
   dsp->convolve[0][1][1][1] = ConvolveCompound2D_SSE4_1;
 
+#if DSP_ENABLED_8BPP_SSE4_1(ConvolveIntraBlockCopy)
+  dsp->convolve[1][0][0][0] = ConvolveIntraBlockCopy_SSE4_1<uint8_t>;
+#endif
   dsp->convolve[1][0][0][1] = ConvolveIntraBlockCopyHorizontal_SSE4_1;
   dsp->convolve[1][0][1][0] = ConvolveIntraBlockCopyVertical_SSE4_1;
   dsp->convolve[1][0][1][1] = ConvolveIntraBlockCopy2D_SSE4_1;
@@ -2814,7 +2885,29 @@ void Init8bpp() {
 }  // namespace
 }  // namespace low_bitdepth
 
-void ConvolveInit_SSE4_1() { low_bitdepth::Init8bpp(); }
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  static_cast<void>(dsp);
+#if DSP_ENABLED_10BPP_SSE4_1(ConvolveIntraBlockCopy)
+  dsp->convolve[1][0][0][0] = ConvolveIntraBlockCopy_SSE4_1<uint16_t>;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void ConvolveInit_SSE4_1() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
 
 }  // namespace dsp
 }  // namespace libgav1
@@ -0,0 +1,564 @@
+// Copyright 2020 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/intrapred.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/dsp/x86/common_sse4.h"
+#include "src/utils/common.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace low_bitdepth {
+namespace {
+
+// Note these constants are duplicated from intrapred.cc to allow the compiler
+// to have visibility of the values.
+constexpr uint8_t kSmoothWeights[] = {
+    // block dimension = 4
+    255, 149, 85, 64,
+    // block dimension = 8
+    255, 197, 146, 105, 73, 50, 37, 32,
+    // block dimension = 16
+    255, 225, 196, 170, 145, 123, 102, 84, 68, 54, 43, 33, 26, 20, 17, 16,
+    // block dimension = 32
+    255, 240, 225, 210, 196, 182, 169, 157, 145, 133, 122, 111, 101, 92, 83, 74,
+    66, 59, 52, 45, 39, 34, 29, 25, 21, 17, 14, 12, 10, 9, 8, 8,
+    // block dimension = 64
+    255, 248, 240, 233, 225, 218, 210, 203, 196, 189, 182, 176, 169, 163, 156,
+    150, 144, 138, 133, 127, 121, 116, 111, 106, 101, 96, 91, 86, 82, 77, 73,
+    69, 65, 61, 57, 54, 50, 47, 44, 41, 38, 35, 32, 29, 27, 25, 22, 20, 18, 16,
+    15, 13, 12, 10, 9, 8, 7, 6, 6, 5, 5, 4, 4, 4};
+
+// The predictors below work on 16 pixels at a time held as 16-bit values, so
+// a row of a block |width| pixels wide is made of |width| / 16 vectors.
+
+// Loads 16 pixels from |src| and widens them to 16 bits.
+inline __m256i LoadWiden16(const uint8_t* const src) {
+  return _mm256_cvtepu8_epi16(LoadUnaligned16(src));
+}
+
+// Narrows 16 16-bit values in [0, 255] to 8 bits, keeping their order.
+inline __m128i PackUnsigned16(const __m256i v) {
+  return _mm_packus_epi16(_mm256_castsi256_si128(v),
+                          _mm256_extracti128_si256(v, 1));
+}
+
+// Narrows the 16-bit values of |lo| and |hi| to 32 pixels, keeping their
+// order. _mm256_packus_epi16() interleaves its inputs per 128-bit lane, which
+// the permute undoes.
+inline __m256i PackUnsigned16x32(const __m256i lo, const __m256i hi) {
+  return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+}
+
+template <int width>
+inline void StoreRow(uint8_t* const dst, const __m256i* const row) {
+  if (width == 16) {
+    StoreUnaligned16(dst, PackUnsigned16(row[0]));
+    return;
+  }
+  for (int i = 0; i < width / 16; i += 2) {
+    StoreUnaligned32(dst + 16 * i, PackUnsigned16x32(row[i], row[i + 1]));
+  }
+}
+
+//------------------------------------------------------------------------------
+// Paeth
+
+template <int width, int height>
+void Paeth_AVX2(void* const dest, const ptrdiff_t stride,
+                const void* const top_row, const void* const left_column) {
+  const auto* const top = static_cast<const uint8_t*>(top_row);
+  const auto* const left = static_cast<const uint8_t*>(left_column);
+  auto* dst = static_cast<uint8_t*>(dest);
+  const __m256i top_left = _mm256_set1_epi16(top[-1]);
+  __m256i top_x[width / 16];
+  __m256i top_diff[width / 16];
+  // |left_dist| is the distance between the base value and |left|, which is
+  // |top| - |top_left| and does not depend on the row.
+  __m256i left_dist[width / 16];
+  for (int i = 0; i < width / 16; ++i) {
+    top_x[i] = LoadWiden16(top + 16 * i);
+    top_diff[i] = _mm256_sub_epi16(top_x[i], top_left);
+    left_dist[i] = _mm256_abs_epi16(top_diff[i]);
+  }
+  int y = 0;
+  do {
+    const __m256i left_y = _mm256_set1_epi16(left[y]);
+    const __m256i left_diff = _mm256_sub_epi16(left_y, top_left);
+    const __m256i top_dist = _mm256_abs_epi16(left_diff);
+    __m256i pred[width / 16];
+    for (int i = 0; i < width / 16; ++i) {
+      const __m256i top_left_dist =
+          _mm256_abs_epi16(_mm256_add_epi16(top_diff[i], left_diff));
+      const __m256i top_or_top_left =
+          _mm256_blendv_epi8(top_x[i], top_left,
+                             _mm256_cmpgt_epi16(top_dist, top_left_dist));
+      const __m256i not_left =
+          _mm256_or_si256(_mm256_cmpgt_epi16(left_dist[i], top_dist),
+                          _mm256_cmpgt_epi16(left_dist[i], top_left_dist));
+      pred[i] = _mm256_blendv_epi8(left_y, top_or_top_left, not_left);
+    }
+    StoreRow<width>(dst, pred);
+    dst += stride;
+  } while (++y < height);
+}
+
+//------------------------------------------------------------------------------
+// Smooth
+
+// The 2-D smooth predictor sums two weighted pairs, which can exceed 16 bits,
+// so each pair is evaluated with _mm256_madd_epi16(). The interleave of
+// _mm256_unpack{lo,hi}_epi16() is undone by _mm256_packus_epi32().
+template <int width, int height>
+void Smooth_AVX2(void* const dest, const ptrdiff_t stride,
+                 const void* const top_row, const void* const left_column) {
+  const auto* const top = static_cast<const uint8_t*>(top_row);
+  const auto* const left = static_cast<const uint8_t*>(left_column);
+  auto* dst = static_cast<uint8_t*>(dest);
+  const uint8_t* const weights_x = kSmoothWeights + width - 4;
+  const uint8_t* const weights_y = kSmoothWeights + height - 4;
+  const __m256i bottom_left = _mm256_set1_epi16(left[height - 1]);
+  const __m256i scale = _mm256_set1_epi16(256);
+  const __m256i round = _mm256_set1_epi32(256);
+  // Pairs of (|top[x]|, |bottom_left|) and (|weights_x[x]|,
+  // 256 - |weights_x[x]|).
+  __m256i top_lo[width / 16];
+  __m256i top_hi[width / 16];
+  __m256i weight_x_lo[width / 16];
+  __m256i weight_x_hi[width / 16];
+  for (int i = 0; i < width / 16; ++i) {
+    const __m256i top_x = LoadWiden16(top + 16 * i);
+    top_lo[i] = _mm256_unpacklo_epi16(top_x, bottom_left);
+    top_hi[i] = _mm256_unpackhi_epi16(top_x, bottom_left);
+    const __m256i weight_x = LoadWiden16(weights_x + 16 * i);
+    const __m256i inverted_weight_x = _mm256_sub_epi16(scale, weight_x);
+    weight_x_lo[i] = _mm256_unpacklo_epi16(weight_x, inverted_weight_x);
+    weight_x_hi[i] = _mm256_unpackhi_epi16(weight_x, inverted_weight_x);
+  }
+  const int top_right = top[width - 1];
+  int y = 0;
+  do {
+    const int weight_y = weights_y[y];
+    const __m256i weight_y_pair =
+        _mm256_set1_epi32(((256 - weight_y) << 16) | weight_y);
+    const __m256i left_pair = _mm256_set1_epi32((top_right << 16) | left[y]);
+    __m256i pred[width / 16];
+    for (int i = 0; i < width / 16; ++i) {
+      const __m256i sum_lo = _mm256_add_epi32(
+          _mm256_madd_epi16(top_lo[i], weight_y_pair),
+          _mm256_madd_epi16(weight_x_lo[i], left_pair));
+      const __m256i sum_hi = _mm256_add_epi32(
+          _mm256_madd_epi16(top_hi[i], weight_y_pair),
+          _mm256_madd_epi16(weight_x_hi[i], left_pair));
+      pred[i] = _mm256_packus_epi32(
+          _mm256_srli_epi32(_mm256_add_epi32(sum_lo, round), 9),
+          _mm256_srli_epi32(_mm256_add_epi32(sum_hi, round), 9));
+    }
+    StoreRow<width>(dst, pred);
+    dst += stride;
+  } while (++y < height);
+}
+
+// For the 1-D smooth predictors the weighted pair sums to at most 255 * 256
+// plus the rounding term, which fits in unsigned 16 bits.
+template <int width, int height>
+void SmoothVertical_AVX2(void* const dest, const ptrdiff_t stride,
+                         const void* const top_row,
+                         const void* const left_column) {
+  const auto* const top = static_cast<const uint8_t*>(top_row);
+  const auto* const left = static_cast<const uint8_t*>(left_column);
+  auto* dst = static_cast<uint8_t*>(dest);
+  const uint8_t* const weights_y = kSmoothWeights + height - 4;
+  const int bottom_left = left[height - 1];
+  __m256i top_x[width / 16];
+  for (int i = 0; i < width / 16; ++i) {
+    top_x[i] = LoadWiden16(top + 16 * i);
+  }
+  int y = 0;
+  do {
+    const int weight_y = weights_y[y];
+    const __m256i weight = _mm256_set1_epi16(weight_y);
+    const __m256i bottom_left_term =
+        _mm256_set1_epi16((256 - weight_y) * bottom_left + 128);
+    __m256i pred[width / 16];
+    for (int i = 0; i < width / 16; ++i) {
+      pred[i] = _mm256_srli_epi16(
+          _mm256_add_epi16(_mm256_mullo_epi16(top_x[i], weight),
+                           bottom_left_term),
+          8);
+    }
+    StoreRow<width>(dst, pred);
+    dst += stride;
+  } while (++y < height);
+}
+
+template <int width, int height>
+void SmoothHorizontal_AVX2(void* const dest, const ptrdiff_t stride,
+                           const void* const top_row,
+                           const void* const left_column) {
+  const auto* const top = static_cast<const uint8_t*>(top_row);
+  const auto* const left = static_cast<const uint8_t*>(left_column);
+  auto* dst = static_cast<uint8_t*>(dest);
+  const uint8_t* const weights_x = kSmoothWeights + width - 4;
+  const __m256i scale = _mm256_set1_epi16(256);
+  const __m256i top_right = _mm256_set1_epi16(top[width - 1]);
+  const __m256i round = _mm256_set1_epi16(128);
+  __m256i weight_x[width / 16];
+  __m256i top_right_term[width / 16];
+  for (int i = 0; i < width / 16; ++i) {
+    weight_x[i] = LoadWiden16(weights_x + 16 * i);
+    top_right_term[i] = _mm256_add_epi16(
+        _mm256_mullo_epi16(_mm256_sub_epi16(scale, weight_x[i]), top_right),
+        round);
+  }
+  int y = 0;
+  do {
+    const __m256i left_y = _mm256_set1_epi16(left[y]);
+    __m256i pred[width / 16];
+    for (int i = 0; i < width / 16; ++i) {
+      pred[i] = _mm256_srli_epi16(
+          _mm256_add_epi16(_mm256_mullo_epi16(weight_x[i], left_y),
+                           top_right_term[i]),
+          8);
+    }
+    StoreRow<width>(dst, pred);
+    dst += stride;
+  } while (++y < height);
+}
+
+//------------------------------------------------------------------------------
+// 7.11.2.4. Directional intra prediction process
+
+// The implementation installed before this one. It is used for the blocks
+// narrower than 16 pixels and for upsampled edges, which the SSE4.1 version
+// already covers well.
+DirectionalIntraPredictorZone1Func zone1_fallback = nullptr;
+
+inline __m256i RightShiftWithRounding5_U16(const __m256i v) {
+  return _mm256_srli_epi16(_mm256_add_epi16(v, _mm256_set1_epi16(16)), 5);
+}
+
+void DirectionalIntraPredictorZone1_AVX2(void* const dest, ptrdiff_t stride,
+                                         const void* const top_row,
+                                         const int width, const int height,
+                                         const int xstep,
+                                         const bool upsampled_top) {
+  if (width < 16 || upsampled_top) {
+    zone1_fallback(dest, stride, top_row, width, height, xstep, upsampled_top);
+    return;
+  }
+  const auto* const top = static_cast<const uint8_t*>(top_row);
+  auto* dst = static_cast<uint8_t*>(dest);
+  assert(xstep > 0);
+  const int max_base_x = width + height - 1;
+  const __m256i max_base = _mm256_set1_epi16(top[max_base_x]);
+  const __m256i offsets = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+                                            11, 12, 13, 14, 15);
+  int top_x = xstep;
+  int y = 0;
+  do {
+    const int top_base_x = top_x >> 6;
+    if (top_base_x >= max_base_x) {
+      for (int i = y; i < height; ++i) {
+        memset(dst, top[max_base_x], width);
+        dst += stride;
+      }
+      return;
+    }
+    const int shift = (top_x & 0x3F) >> 1;
+    if (width >= 32 && top_base_x + width <= max_base_x) {
+      // Every pixel of the row interpolates between two edge pixels and no
+      // load reaches past |max_base_x|, so 32 pixels are produced at a time
+      // from byte pairs.
+      const __m256i weights =
+          _mm256_set1_epi16(static_cast<int16_t>((shift << 8) | (32 - shift)));
+      int x = 0;
+      do {
+        const __m256i a = LoadUnaligned32(top + top_base_x + x);
+        const __m256i b = LoadUnaligned32(top + top_base_x + x + 1);
+        const __m256i lo =
+            _mm256_maddubs_epi16(_mm256_unpacklo_epi8(a, b), weights);
+        const __m256i hi =
+            _mm256_maddubs_epi16(_mm256_unpackhi_epi8(a, b), weights);
+        StoreUnaligned32(dst + x,
+                         _mm256_packus_epi16(RightShiftWithRounding5_U16(lo),
+                                             RightShiftWithRounding5_U16(hi)));
+        x += 32;
+      } while (x < width);
+    } else {
+      // The row reaches the end of the edge. Pixels at or past |max_base_x|
+      // take the value of the last edge pixel.
+      const __m256i shift_v = _mm256_set1_epi16(shift);
+      int x = 0;
+      do {
+        const int base = top_base_x + x;
+        if (base >= max_base_x) {
+          memset(dst + x, top[max_base_x], width - x);
+          break;
+        }
+        // The loads may read up to 15 pixels past |max_base_x|. The edge
+        // buffer leaves room for them and their results are discarded.
+        const __m256i a = LoadWiden16(top + base);
+        const __m256i b = LoadWiden16(top + base + 1);
+        const __m256i val = RightShiftWithRounding5_U16(_mm256_add_epi16(
+            _mm256_slli_epi16(a, 5),
+            _mm256_mullo_epi16(_mm256_sub_epi16(b, a), shift_v)));
+        const __m256i in_range =
+            _mm256_cmpgt_epi16(_mm256_set1_epi16(max_base_x - base), offsets);
+        StoreUnaligned16(dst + x, PackUnsigned16(_mm256_blendv_epi8(
+                                      max_base, val, in_range)));
+        x += 16;
+      } while (x < width);
+    }
+    dst += stride;
+    top_x += xstep;
+  } while (++y < height);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+  // The AVX2 version only covers part of the blocks, so it does not claim
+  // LIBGAV1_Dsp8bpp_DirectionalIntraPredictorZone1 and the SSE4.1 or C version
+  // is installed before it.
+  if (dsp->directional_intra_predictor_zone1 != nullptr &&
+      dsp->directional_intra_predictor_zone1 !=
+          DirectionalIntraPredictorZone1_AVX2) {
+    zone1_fallback = dsp->directional_intra_predictor_zone1;
+    dsp->directional_intra_predictor_zone1 =
+        DirectionalIntraPredictorZone1_AVX2;
+  }
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x4_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize16x4][kIntraPredictorPaeth] =
+      Paeth_AVX2<16, 4>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x8_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize16x8][kIntraPredictorPaeth] =
+      Paeth_AVX2<16, 8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x16_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize16x16][kIntraPredictorPaeth] =
+      Paeth_AVX2<16, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x32_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize16x32][kIntraPredictorPaeth] =
+      Paeth_AVX2<16, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x64_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize16x64][kIntraPredictorPaeth] =
+      Paeth_AVX2<16, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x8_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorPaeth] =
+      Paeth_AVX2<32, 8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x16_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorPaeth] =
+      Paeth_AVX2<32, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x32_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorPaeth] =
+      Paeth_AVX2<32, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x64_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorPaeth] =
+      Paeth_AVX2<32, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x16_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorPaeth] =
+      Paeth_AVX2<64, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x32_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorPaeth] =
+      Paeth_AVX2<64, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x64_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorPaeth] =
+      Paeth_AVX2<64, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x4_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize16x4][kIntraPredictorSmooth] =
+      Smooth_AVX2<16, 4>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x8_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize16x8][kIntraPredictorSmooth] =
+      Smooth_AVX2<16, 8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x16_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize16x16][kIntraPredictorSmooth] =
+      Smooth_AVX2<16, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x32_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize16x32][kIntraPredictorSmooth] =
+      Smooth_AVX2<16, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x64_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize16x64][kIntraPredictorSmooth] =
+      Smooth_AVX2<16, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x8_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorSmooth] =
+      Smooth_AVX2<32, 8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x16_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorSmooth] =
+      Smooth_AVX2<32, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x32_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorSmooth] =
+      Smooth_AVX2<32, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x64_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorSmooth] =
+      Smooth_AVX2<32, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x16_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorSmooth] =
+      Smooth_AVX2<64, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x32_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorSmooth] =
+      Smooth_AVX2<64, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x64_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorSmooth] =
+      Smooth_AVX2<64, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x4_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize16x4][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<16, 4>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x8_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize16x8][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<16, 8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x16_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize16x16][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<16, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x32_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize16x32][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<16, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x64_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize16x64][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<16, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x8_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<32, 8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x16_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<32, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x32_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<32, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x64_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<32, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x16_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<64, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x32_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<64, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x64_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<64, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x4_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize16x4][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<16, 4>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x8_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize16x8][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<16, 8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x16_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize16x16][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<16, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x32_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize16x32][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<16, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize16x64_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize16x64][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<16, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x8_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<32, 8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x16_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<32, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x32_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<32, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x64_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<32, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x16_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<64, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x32_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<64, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x64_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<64, 64>;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+void IntraPredInit_AVX2() { low_bitdepth::Init8bpp(); }
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else  // !LIBGAV1_TARGETING_AVX2
+namespace libgav1 {
+namespace dsp {
+
+void IntraPredInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
@@ -2739,6 +2739,48 @@ void FilterIntraPredictor_SSE4_1(void* const dest, ptrdiff_t stride,
   }
 }
 
+//------------------------------------------------------------------------------
+// PalettePredictor_SSE4_1
+
+// The colors are narrowed to bytes so that a byte shuffle with the color
+// indices looks up 16 pixels at once. Indices are less than kMaxPaletteSize, so
+// the unused upper half of the shuffle table is never selected.
+void PalettePredictor_SSE4_1(void* const dest, const ptrdiff_t stride,
+                             const uint8_t* color_index_map,
+                             const ptrdiff_t color_index_map_stride,
+                             const uint16_t* const palette, const int width,
+                             const int height) {
+  auto* dst = static_cast<uint8_t*>(dest);
+  const __m128i colors = LoadUnaligned16(palette);
+  const __m128i colors8 = _mm_packus_epi16(colors, colors);
+  int y = height;
+  if (width == 4) {
+    do {
+      Store4(dst, _mm_shuffle_epi8(colors8, Load4(color_index_map)));
+      dst += stride;
+      color_index_map += color_index_map_stride;
+    } while (--y != 0);
+  } else if (width == 8) {
+    do {
+      StoreLo8(dst, _mm_shuffle_epi8(colors8, LoadLo8(color_index_map)));
+      dst += stride;
+      color_index_map += color_index_map_stride;
+    } while (--y != 0);
+  } else {
+    do {
+      int x = 0;
+      do {
+        StoreUnaligned16(dst + x,
+                         _mm_shuffle_epi8(colors8, LoadUnaligned16(
+                                                       color_index_map + x)));
+        x += 16;
+      } while (x < width);
+      dst += stride;
+      color_index_map += color_index_map_stride;
+    } while (--y != 0);
+  }
+}
+
 void Init8bpp() {
   Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
   assert(dsp != nullptr);
@@ -2749,6 +2791,9 @@ void Init8bpp() {
 #if DSP_ENABLED_8BPP_SSE4_1(FilterIntraPredictor)
   dsp->filter_intra_predictor = FilterIntraPredictor_SSE4_1;
 #endif
+#if DSP_ENABLED_8BPP_SSE4_1(PalettePredictor)
+  dsp->palette_predictor = PalettePredictor_SSE4_1;
+#endif
 #if DSP_ENABLED_8BPP_SSE4_1(DirectionalIntraPredictorZone1)
   dsp->directional_intra_predictor_zone1 =
       DirectionalIntraPredictorZone1_SSE4_1;
@@ -3416,10 +3461,50 @@ struct DirDefs {
       DirectionalPredFuncs_SSE4_1<ColStore64_SSE4_1<WriteDuplicate64x4>>;
 };
 
+// Each 16-bit color is looked up by shuffling with the byte pair
+// (2 * index, 2 * index + 1).
+inline __m128i PaletteLookup8(const __m128i colors, const __m128i indices) {
+  const __m128i low_bytes = _mm_add_epi8(indices, indices);
+  const __m128i high_bytes = _mm_add_epi8(low_bytes, _mm_set1_epi8(1));
+  return _mm_shuffle_epi8(colors, _mm_unpacklo_epi8(low_bytes, high_bytes));
+}
+
+void PalettePredictor_SSE4_1(void* const dest, ptrdiff_t stride,
+                             const uint8_t* color_index_map,
+                             const ptrdiff_t color_index_map_stride,
+                             const uint16_t* const palette, const int width,
+                             const int height) {
+  auto* dst = static_cast<uint16_t*>(dest);
+  stride /= sizeof(dst[0]);
+  const __m128i colors = LoadUnaligned16(palette);
+  int y = height;
+  if (width == 4) {
+    do {
+      StoreLo8(dst, PaletteLookup8(colors, Load4(color_index_map)));
+      dst += stride;
+      color_index_map += color_index_map_stride;
+    } while (--y != 0);
+  } else {
+    do {
+      int x = 0;
+      do {
+        StoreUnaligned16(dst + x,
+                         PaletteLookup8(colors, LoadLo8(color_index_map + x)));
+        x += 8;
+      } while (x < width);
+      dst += stride;
+      color_index_map += color_index_map_stride;
+    } while (--y != 0);
+  }
+}
+
 void Init10bpp() {
   Dsp* const dsp = dsp_internal::GetWritableDspTable(10);
   assert(dsp != nullptr);
   static_cast<void>(dsp);
+#if DSP_ENABLED_10BPP_SSE4_1(PalettePredictor)
+  dsp->palette_predictor = PalettePredictor_SSE4_1;
+#endif
 #if DSP_ENABLED_10BPP_SSE4_1(TransformSize4x4_IntraPredictorDcTop)
   dsp->intra_predictors[kTransformSize4x4][kIntraPredictorDcTop] =
       DcDefs::_4x4::DcTop;
@@ -24,9 +24,9 @@ namespace libgav1 {
 namespace dsp {
 
 // Initializes Dsp::intra_predictors, Dsp::directional_intra_predictor_zone*,
-// Dsp::cfl_intra_predictors, Dsp::cfl_subsamplers and
-// Dsp::filter_intra_predictor, see the defines below for specifics. These
-// functions are not thread-safe.
+// Dsp::cfl_intra_predictors, Dsp::cfl_subsamplers,
+// Dsp::filter_intra_predictor and Dsp::palette_predictor, see the defines below
+// for specifics. These functions are not thread-safe.
 void IntraPredInit_SSE4_1();
 void IntraPredCflInit_SSE4_1();
 void IntraPredSmoothInit_SSE4_1();
@@ -41,6 +41,10 @@ void IntraPredSmoothInit_SSE4_1();
 #define LIBGAV1_Dsp8bpp_FilterIntraPredictor LIBGAV1_CPU_SSE4_1
 #endif
 
+#ifndef LIBGAV1_Dsp8bpp_PalettePredictor
+#define LIBGAV1_Dsp8bpp_PalettePredictor LIBGAV1_CPU_SSE4_1
+#endif
+
 #ifndef LIBGAV1_Dsp8bpp_DirectionalIntraPredictorZone1
 #define LIBGAV1_Dsp8bpp_DirectionalIntraPredictorZone1 LIBGAV1_CPU_SSE4_1
 #endif
@@ -942,6 +946,10 @@ void IntraPredSmoothInit_SSE4_1();
 //------------------------------------------------------------------------------
 // 10bpp
 
+#ifndef LIBGAV1_Dsp10bpp_PalettePredictor
+#define LIBGAV1_Dsp10bpp_PalettePredictor LIBGAV1_CPU_SSE4_1
+#endif
+
 #ifndef LIBGAV1_Dsp10bpp_TransformSize4x4_IntraPredictorDcTop
 #define LIBGAV1_Dsp10bpp_TransformSize4x4_IntraPredictorDcTop LIBGAV1_CPU_SSE4_1
 #endif
@@ -484,14 +484,28 @@ LIBGAV1_ALWAYS_INLINE void Dct16Stages(__m128i* s) {
   HadamardRotation(&s[7], &s[8], false);
 }
 
-// Process dct16 rows or columns, depending on the transpose flag.
-template <ButterflyRotationFunc butterfly_rotation, bool stage_is_rectangular>
+// Process dct16 rows or columns, depending on the transpose flag. If
+// |is_fast_butterfly| is true, only the first 8 inputs may be non-zero.
+template <ButterflyRotationFunc butterfly_rotation, bool stage_is_rectangular,
+          bool is_fast_butterfly = false>
 LIBGAV1_ALWAYS_INLINE void Dct16_SSE4_1(void* dest, int32_t step,
                                         bool transpose) {
+  static_assert(!is_fast_butterfly || !stage_is_rectangular, "");
   auto* const dst = static_cast<int16_t*>(dest);
   __m128i s[16], x[16];
 
-  if (stage_is_rectangular) {
+  if (is_fast_butterfly) {
+    if (transpose) {
+      __m128i input[8];
+      LoadSrc<16, 8>(dst, step, 0, input);
+      Transpose8x8_U16(input, x);
+    } else {
+      LoadSrc<16, 8>(dst, step, 0, x);
+    }
+    for (int i = 8; i < 16; ++i) {
+      x[i] = _mm_setzero_si128();
+    }
+  } else if (stage_is_rectangular) {
     if (transpose) {
       __m128i input[4];
       LoadSrc<16, 4>(dst, step, 0, input);
@@ -532,9 +546,9 @@ LIBGAV1_ALWAYS_INLINE void Dct16_SSE4_1(void* dest, int32_t step,
   s[14] = x[7];
   s[15] = x[15];
 
-  Dct4Stages<butterfly_rotation>(s);
-  Dct8Stages<butterfly_rotation>(s);
-  Dct16Stages<butterfly_rotation>(s);
+  Dct4Stages<butterfly_rotation, is_fast_butterfly>(s);
+  Dct8Stages<butterfly_rotation, is_fast_butterfly>(s);
+  Dct16Stages<butterfly_rotation, is_fast_butterfly>(s);
 
   if (stage_is_rectangular) {
     if (transpose) {
@@ -649,21 +663,29 @@ LIBGAV1_ALWAYS_INLINE void Dct32Stages(__m128i* s) {
   HadamardRotation(&s[15], &s[16], false);
 }
 
-// Process dct32 rows or columns, depending on the transpose flag.
+// Process dct32 rows or columns, depending on the transpose flag. If
+// |is_fast_butterfly| is true, only the first 16 inputs may be non-zero.
+template <bool is_fast_butterfly = false>
 LIBGAV1_ALWAYS_INLINE void Dct32_SSE4_1(void* dest, const int32_t step,
                                         const bool transpose) {
   auto* const dst = static_cast<int16_t*>(dest);
   __m128i s[32], x[32];
+  const int num_inputs = is_fast_butterfly ? 16 : 32;
 
   if (transpose) {
-    for (int idx = 0; idx < 32; idx += 8) {
+    for (int idx = 0; idx < num_inputs; idx += 8) {
       __m128i input[8];
       LoadSrc<16, 8>(dst, step, idx, input);
       Transpose8x8_U16(input, &x[idx]);
     }
+  } else if (is_fast_butterfly) {
+    LoadSrc<16, 16>(dst, step, 0, x);
   } else {
     LoadSrc<16, 32>(dst, step, 0, x);
   }
+  for (int i = num_inputs; i < 32; ++i) {
+    x[i] = _mm_setzero_si128();
+  }
 
   // stage 1
   // kBitReverseLookup
@@ -703,10 +725,10 @@ LIBGAV1_ALWAYS_INLINE void Dct32_SSE4_1(void* dest, const int32_t step,
   s[30] = x[15];
   s[31] = x[31];
 
-  Dct4Stages<ButterflyRotation_8>(s);
-  Dct8Stages<ButterflyRotation_8>(s);
-  Dct16Stages<ButterflyRotation_8>(s);
-  Dct32Stages<ButterflyRotation_8>(s);
+  Dct4Stages<ButterflyRotation_8, is_fast_butterfly>(s);
+  Dct8Stages<ButterflyRotation_8, is_fast_butterfly>(s);
+  Dct16Stages<ButterflyRotation_8, is_fast_butterfly>(s);
+  Dct32Stages<ButterflyRotation_8, is_fast_butterfly>(s);
 
   if (transpose) {
     for (int idx = 0; idx < 32; idx += 8) {
@@ -2916,6 +2938,152 @@ void Wht4TransformLoopColumn_SSE4_1(TransformType tx_type,
   Wht4_SSE4_1(frame, start_x, start_y, src, adjusted_tx_height);
 }
 
+//------------------------------------------------------------------------------
+// Dct-Dct sub-region transforms.
+
+// Adds the constant |residual_value| to the |tx_width|x|tx_height| block at
+// (|start_x|, |start_y|). One of |v_add| and |v_sub| is always zero, so the
+// saturating byte operations give Clip3(pixel + residual_value, 0, 255).
+template <int tx_height>
+LIBGAV1_ALWAYS_INLINE void AddDcToFrame(Array2DView<uint8_t> frame,
+                                        const int start_x, const int start_y,
+                                        const int tx_width,
+                                        const int residual_value) {
+  const __m128i v_add =
+      _mm_set1_epi8(static_cast<char>(Clip3(residual_value, 0, 255)));
+  const __m128i v_sub =
+      _mm_set1_epi8(static_cast<char>(Clip3(-residual_value, 0, 255)));
+  const int stride = frame.columns();
+  uint8_t* dst = frame[start_y] + start_x;
+  if (tx_width == 4) {
+    for (int i = 0; i < tx_height; ++i) {
+      const __m128i a = _mm_adds_epu8(Load4(dst), v_add);
+      Store4(dst, _mm_subs_epu8(a, v_sub));
+      dst += stride;
+    }
+  } else if (tx_width == 8) {
+    for (int i = 0; i < tx_height; ++i) {
+      const __m128i a = _mm_adds_epu8(LoadLo8(dst), v_add);
+      StoreLo8(dst, _mm_subs_epu8(a, v_sub));
+      dst += stride;
+    }
+  } else {
+    for (int i = 0; i < tx_height; ++i) {
+      int j = 0;
+      do {
+        const __m128i a = _mm_adds_epu8(LoadUnaligned16(&dst[j]), v_add);
+        StoreUnaligned16(&dst[j], _mm_subs_epu8(a, v_sub));
+        j += 16;
+      } while (j < tx_width);
+      dst += stride;
+    }
+  }
+}
+
+// The row transform, column transform and rounding mirror DctDcOnly(),
+// DctDcOnlyColumn() and StoreToFrameWithRound() for a single value, since every
+// position of a DC-only block receives the same residual.
+template <int tx_height>
+void DctDcOnlyTransformAdd_SSE4_1(TransformSize tx_size, void* src_buffer,
+                                  int start_x, int start_y, void* dst_frame) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  const __m128i v_src = _mm_set1_epi16(src[0]);
+  const __m128i v_src_round = _mm_mulhrs_epi16(
+      v_src, _mm_set1_epi16(kTransformRowMultiplier << 3));
+  const __m128i s0 = should_round ? v_src_round : v_src;
+  const int16_t cos128 = Cos128(32);
+  const __m128i xy = _mm_mulhrs_epi16(s0, _mm_set1_epi16(cos128 << 3));
+  // Expand to 32 bits to prevent int16_t overflows during the shift add.
+  const __m128i v_row_shift_add = _mm_set1_epi32(row_shift);
+  const __m128i v_row_shift = _mm_cvtepu32_epi64(v_row_shift_add);
+  const __m128i a = _mm_add_epi32(_mm_cvtepi16_epi32(xy), v_row_shift_add);
+  const __m128i b = _mm_sra_epi32(a, v_row_shift);
+  const __m128i row = _mm_packs_epi32(b, b);
+  const __m128i column = _mm_mulhrs_epi16(row, _mm_set1_epi16(cos128 << 3));
+  // Saturate to prevent overflowing int16_t
+  const __m128i residual =
+      _mm_srai_epi16(_mm_adds_epi16(column, _mm_set1_epi16(8)), 4);
+
+  auto& frame = *static_cast<Array2DView<uint8_t>*>(dst_frame);
+  AddDcToFrame<tx_height>(frame, start_x, start_y, tx_width,
+                          static_cast<int16_t>(_mm_extract_epi16(residual, 0)));
+}
+
+// Row transforms for the sub-region transforms. Only the first |num_rows| rows
+// are processed and at most half of the inputs of each row are non-zero.
+template <int tx_width>
+LIBGAV1_ALWAYS_INLINE void DctSubRegionRows(int16_t* src, int num_rows,
+                                            bool should_round,
+                                            uint8_t row_shift) {
+  if (should_round) {
+    ApplyRounding<tx_width>(src, num_rows);
+  }
+  // Process 8 1d dct rows in parallel per iteration.
+  int i = 0;
+  do {
+    if (tx_width == 16) {
+      Dct16_SSE4_1<ButterflyRotation_8, false, /*is_fast_butterfly=*/true>(
+          &src[i * 16], 16, /*transpose=*/true);
+    } else if (tx_width == 32) {
+      Dct32_SSE4_1</*is_fast_butterfly=*/true>(&src[i * 32], 32,
+                                               /*transpose=*/true);
+    } else {
+      // Dct64_SSE4_1() always assumes the last 32 inputs are zero.
+      Dct64_SSE4_1(&src[i * 64], 64, /*transpose=*/true);
+    }
+    i += 8;
+  } while (i < num_rows);
+  RowShift<tx_width>(src, num_rows, row_shift);
+}
+
+// Applies the Dct-Dct transform to a block whose non-zero coefficients lie in
+// the top-left |sub_region_size|x|sub_region_size| region. Only the first
+// |sub_region_size| rows need the row transform and, since at most half of
+// the inputs of every row and column are non-zero, all the first stage
+// butterfly rotations have a zero input.
+template <int tx_height, int sub_region_size>
+void DctSubRegionTransformAdd_SSE4_1(TransformSize tx_size, void* src_buffer,
+                                     int start_x, int start_y,
+                                     void* dst_frame) {
+  static_assert(2 * sub_region_size <= tx_height, "");
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+  assert(2 * sub_region_size <= tx_width);
+
+  if (tx_width == 16) {
+    DctSubRegionRows<16>(src, sub_region_size, should_round, row_shift);
+  } else if (tx_width == 32) {
+    DctSubRegionRows<32>(src, sub_region_size, should_round, row_shift);
+  } else {
+    assert(tx_width == 64);
+    DctSubRegionRows<64>(src, sub_region_size, should_round, row_shift);
+  }
+
+  // Process 8 1d dct columns in parallel per iteration.
+  int i = 0;
+  do {
+    if (tx_height == 16) {
+      Dct16_SSE4_1<ButterflyRotation_8, false, /*is_fast_butterfly=*/true>(
+          &src[i], tx_width, /*transpose=*/false);
+    } else if (tx_height == 32) {
+      Dct32_SSE4_1</*is_fast_butterfly=*/true>(&src[i], tx_width,
+                                               /*transpose=*/false);
+    } else {
+      Dct64_SSE4_1(&src[i], tx_width, /*transpose=*/false);
+    }
+    i += 8;
+  } while (i < tx_width);
+  auto& frame = *static_cast<Array2DView<uint8_t>*>(dst_frame);
+  StoreToFrameWithRound(frame, start_x, start_y, tx_width, tx_height, src,
+                        kTransformTypeDctDct);
+}
+
 //------------------------------------------------------------------------------
 
 template <typename Residual, typename Pixel>
@@ -2979,6 +3147,39 @@ void InitAll(Dsp* const dsp) {
       Wht4TransformLoopRow_SSE4_1;
   dsp->inverse_transforms[k1DTransformWht][k1DTransformSize4][kColumn] =
       Wht4TransformLoopColumn_SSE4_1;
+
+  // Dct-Dct sub-region transforms. The sub-regions are only used for
+  // transforms with at least twice the sub-region size in each dimension.
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize4] =
+      DctDcOnlyTransformAdd_SSE4_1<4>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize8] =
+      DctDcOnlyTransformAdd_SSE4_1<8>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize16] =
+      DctDcOnlyTransformAdd_SSE4_1<16>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize32] =
+      DctDcOnlyTransformAdd_SSE4_1<32>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize64] =
+      DctDcOnlyTransformAdd_SSE4_1<64>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion8x8]
+                                        [k1DTransformSize16] =
+      DctSubRegionTransformAdd_SSE4_1<16, 8>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion8x8]
+                                        [k1DTransformSize32] =
+      DctSubRegionTransformAdd_SSE4_1<32, 8>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion8x8]
+                                        [k1DTransformSize64] =
+      DctSubRegionTransformAdd_SSE4_1<64, 8>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion16x16]
+                                        [k1DTransformSize32] =
+      DctSubRegionTransformAdd_SSE4_1<32, 16>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion16x16]
+                                        [k1DTransformSize64] =
+      DctSubRegionTransformAdd_SSE4_1<64, 16>;
 }
 
 void Init8bpp() {
@@ -3065,6 +3266,40 @@ void Init8bpp() {
   dsp->inverse_transforms[k1DTransformWht][k1DTransformSize4][kColumn] =
       Wht4TransformLoopColumn_SSE4_1;
 #endif
+#if DSP_ENABLED_8BPP_SSE4_1(InverseTransformDctDcOnly)
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize4] =
+      DctDcOnlyTransformAdd_SSE4_1<4>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize8] =
+      DctDcOnlyTransformAdd_SSE4_1<8>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize16] =
+      DctDcOnlyTransformAdd_SSE4_1<16>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize32] =
+      DctDcOnlyTransformAdd_SSE4_1<32>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegionDcOnly]
+                                        [k1DTransformSize64] =
+      DctDcOnlyTransformAdd_SSE4_1<64>;
+#endif
+#if DSP_ENABLED_8BPP_SSE4_1(InverseTransformDctSubRegion)
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion8x8]
+                                        [k1DTransformSize16] =
+      DctSubRegionTransformAdd_SSE4_1<16, 8>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion8x8]
+                                        [k1DTransformSize32] =
+      DctSubRegionTransformAdd_SSE4_1<32, 8>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion8x8]
+                                        [k1DTransformSize64] =
+      DctSubRegionTransformAdd_SSE4_1<64, 8>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion16x16]
+                                        [k1DTransformSize32] =
+      DctSubRegionTransformAdd_SSE4_1<32, 16>;
+  dsp->inverse_transforms_dct_sub_region[kTransformSubRegion16x16]
+                                        [k1DTransformSize64] =
+      DctSubRegionTransformAdd_SSE4_1<64, 16>;
+#endif
 #endif
 }
 
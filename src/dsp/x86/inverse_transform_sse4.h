@@ -23,7 +23,8 @@
 namespace libgav1 {
 namespace dsp {
 
-// Initializes Dsp::inverse_transforms, see the defines below for specifics.
+// Initializes Dsp::inverse_transforms and
+// Dsp::inverse_transforms_dct_sub_region, see the defines below for specifics.
 // This function is not thread-safe.
 void InverseTransformInit_SSE4_1();
 
@@ -85,5 +86,13 @@ void InverseTransformInit_SSE4_1();
 #ifndef LIBGAV1_Dsp8bpp_1DTransformSize4_1DTransformWht
 #define LIBGAV1_Dsp8bpp_1DTransformSize4_1DTransformWht LIBGAV1_CPU_SSE4_1
 #endif
+
+#ifndef LIBGAV1_Dsp8bpp_InverseTransformDctDcOnly
+#define LIBGAV1_Dsp8bpp_InverseTransformDctDcOnly LIBGAV1_CPU_SSE4_1
+#endif
+
+#ifndef LIBGAV1_Dsp8bpp_InverseTransformDctSubRegion
+#define LIBGAV1_Dsp8bpp_InverseTransformDctSubRegion LIBGAV1_CPU_SSE4_1
+#endif
 #endif  // LIBGAV1_TARGETING_SSE4_1
 #endif  // LIBGAV1_SRC_DSP_X86_INVERSE_TRANSFORM_SSE4_H_
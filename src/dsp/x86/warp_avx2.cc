@@ -0,0 +1,401 @@
+// Copyright 2020 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/warp.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/dsp/x86/common_sse4.h"
+#include "src/utils/common.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace low_bitdepth {
+namespace {
+
+// Two 8x8 blocks are processed at a time, one in each 128-bit lane. Within a
+// lane, the computation is the same as in warp_sse4.cc.
+
+// Number of extra bits of precision in warped filtering.
+constexpr int kWarpedDiffPrecisionBits = 10;
+
+constexpr int kFirstPassOffset = 1 << 14;
+constexpr int kOffsetRemoval =
+    (kFirstPassOffset >> kInterRoundBitsHorizontal) * 128;
+
+// Added to the filter positions so that a shift gives the index of the filter
+// in kWarpedFilters8, rounded.
+constexpr int kFilterIndexBias =
+    (1 << (kWarpedDiffPrecisionBits - 1)) +
+    (kWarpedPixelPrecisionShifts << kWarpedDiffPrecisionBits);
+
+// Where the samples of the horizontal filter of an 8x8 block are read.
+struct WarpBlock {
+  int x4;
+  int y4;
+  // If true, the block is horizontally outside the frame (regions 1 and 2 in
+  // warp_sse4.cc) and every row of the horizontal filter input is made of
+  // copies of a border pixel. |src| points to the border pixel of the first
+  // row. Otherwise |src| points to the first sample of the first row.
+  bool is_border;
+  const uint8_t* src;
+  // Distance between the rows, 0 when they are all clipped to the same row.
+  ptrdiff_t src_stride;
+};
+
+inline void SetupWarpBlock(const uint8_t* const src,
+                           const ptrdiff_t source_stride,
+                           const int source_width, const int source_height,
+                           const int* const warp_params,
+                           const int subsampling_x, const int subsampling_y,
+                           const int src_x, const int src_y,
+                           WarpBlock* const block) {
+  const int dst_x =
+      src_x * warp_params[2] + src_y * warp_params[3] + warp_params[0];
+  const int dst_y =
+      src_x * warp_params[4] + src_y * warp_params[5] + warp_params[1];
+  block->x4 = dst_x >> subsampling_x;
+  block->y4 = dst_y >> subsampling_y;
+  const int ix4 = block->x4 >> kWarpedModelPrecisionBits;
+  const int iy4 = block->y4 >> kWarpedModelPrecisionBits;
+  // The rows iy4 - 7 to iy4 + 7 are read. If they are all outside the frame,
+  // they are clipped to the same row. Otherwise the top and bottom borders of
+  // the reference frame take care of the clipping.
+  const bool is_row_clipped = iy4 - 7 >= source_height - 1 || iy4 + 7 <= 0;
+  const int row = is_row_clipped ? ((iy4 + 7 <= 0) ? 0 : source_height - 1)
+                                 : iy4 - 7;
+  block->src_stride = is_row_clipped ? 0 : source_stride;
+  block->is_border = ix4 - 7 >= source_width - 1 || ix4 + 7 <= 0;
+  if (block->is_border) {
+    const int column = (ix4 + 7 <= 0) ? 0 : source_width - 1;
+    block->src = src + row * source_stride + column;
+  } else {
+    // NOTE: This may read up to 13 bytes before the start of the row or up to
+    // 14 bytes after its end. See the WarpFunc comments in dsp.h.
+    block->src = src + row * source_stride + ix4 - 7;
+  }
+}
+
+// Returns the horizontal filter output of a row made of copies of |pixel|.
+// The filter taps sum to 128, so the output is the same for all the filters.
+inline int16_t BorderRowValue(const uint8_t pixel) {
+  return static_cast<int16_t>(
+      (pixel << (kFilterBits - kInterRoundBitsHorizontal)) -
+      (kFirstPassOffset >> kInterRoundBitsHorizontal));
+}
+
+inline __m256i SetLanes(const __m128i lo, const __m128i hi) {
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+// Loads the 4 filters given by |index| from kWarpedFilters8. The first two
+// filters go in the low lane and the last two in the high lane.
+inline __m256i GatherFilters(const __m128i index) {
+  return _mm256_i32gather_epi64(
+      reinterpret_cast<const long long*>(kWarpedFilters8),  // NOLINT
+      index, sizeof(kWarpedFilters8[0]));
+}
+
+// Returns the filter positions of columns 0, 1 of |block_0|, columns 0, 1 of
+// |block_1|, then columns 2, 3 of both. Columns 4 to 7 are at |step| * 4 from
+// these.
+inline __m256i FilterPositions(const int position_0, const int position_1,
+                               const int step) {
+  const int p0 = position_0 + kFilterIndexBias;
+  const int p1 = position_1 + kFilterIndexBias;
+  return _mm256_setr_epi32(p0 - 4 * step, p0 - 3 * step, p1 - 4 * step,
+                           p1 - 3 * step, p0 - 2 * step, p0 - step,
+                           p1 - 2 * step, p1 - step);
+}
+
+// This assumes the two filters contain filter[x] and filter[x+2].
+inline __m256i AccumulateFilter(const __m256i sum, const __m256i filter_0,
+                                const __m256i filter_1,
+                                const __m256i& src_window) {
+  const __m256i filter_taps = _mm256_unpacklo_epi8(filter_0, filter_1);
+  const __m256i src =
+      _mm256_unpacklo_epi8(src_window, _mm256_srli_si256(src_window, 2));
+  return _mm256_add_epi16(sum, _mm256_maddubs_epi16(src, filter_taps));
+}
+
+// Applies the horizontal filter to the 15 source rows of both blocks. Row y
+// of block i is stored in lane i of |intermediate_result[y]|.
+inline void HorizontalFilter(const WarpBlock block[2], const int alpha,
+                             const int beta,
+                             __m256i intermediate_result[15]) {
+  if (block[0].is_border && block[1].is_border) {
+    for (int y = 0; y < 15; ++y) {
+      intermediate_result[y] = SetLanes(
+          _mm_set1_epi16(BorderRowValue(block[0].src[y * block[0].src_stride])),
+          _mm_set1_epi16(
+              BorderRowValue(block[1].src[y * block[1].src_stride])));
+    }
+    return;
+  }
+  // A border block is filtered with the rows of the other block. The result
+  // of its lane is replaced by the border values afterwards.
+  const WarpBlock& source_0 = block[0].is_border ? block[1] : block[0];
+  const WarpBlock& source_1 = block[1].is_border ? block[0] : block[1];
+  // The filter positions of both blocks are computed together, in the order
+  // in which the filters are gathered.
+  __m256i position_lo = FilterPositions(
+      (block[0].x4 & ((1 << kWarpedModelPrecisionBits) - 1)) - beta * 7,
+      (block[1].x4 & ((1 << kWarpedModelPrecisionBits) - 1)) - beta * 7,
+      alpha);
+  __m256i position_hi =
+      _mm256_add_epi32(position_lo, _mm256_set1_epi32(4 * alpha));
+  const __m256i position_step = _mm256_set1_epi32(beta);
+  const __m256i interleave_filters =
+      _mm256_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15, 0,
+                       8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+  for (int y = 0; y < 15; ++y) {
+    const __m256i index_lo =
+        _mm256_srai_epi32(position_lo, kWarpedDiffPrecisionBits);
+    const __m256i index_hi =
+        _mm256_srai_epi32(position_hi, kWarpedDiffPrecisionBits);
+    // Each lane holds the filters of two columns. Interleave them to get
+    //   00 10 01 11  02 12 03 13  04 14 05 15  06 16 07 17
+    // as in the first step of Transpose8x8To4x16_U8().
+    const __m256i a0 = _mm256_shuffle_epi8(
+        GatherFilters(_mm256_castsi256_si128(index_lo)), interleave_filters);
+    const __m256i a1 = _mm256_shuffle_epi8(
+        GatherFilters(_mm256_extracti128_si256(index_lo, 1)),
+        interleave_filters);
+    const __m256i a2 = _mm256_shuffle_epi8(
+        GatherFilters(_mm256_castsi256_si128(index_hi)), interleave_filters);
+    const __m256i a3 = _mm256_shuffle_epi8(
+        GatherFilters(_mm256_extracti128_si256(index_hi, 1)),
+        interleave_filters);
+    const __m256i b0 = _mm256_unpacklo_epi16(a0, a1);
+    const __m256i b1 = _mm256_unpacklo_epi16(a2, a3);
+    const __m256i b2 = _mm256_unpackhi_epi16(a0, a1);
+    const __m256i b3 = _mm256_unpackhi_epi16(a2, a3);
+    // |filter| now contains two filters per register. See HorizontalFilter()
+    // in warp_sse4.cc for the order of the taps.
+    const __m256i filter[4] = {
+        _mm256_unpacklo_epi32(b0, b1), _mm256_unpackhi_epi32(b0, b1),
+        _mm256_unpacklo_epi32(b2, b3), _mm256_unpackhi_epi32(b2, b3)};
+
+    __m256i src_row_window =
+        SetLanes(LoadUnaligned16(source_0.src + y * source_0.src_stride),
+                 LoadUnaligned16(source_1.src + y * source_1.src_stride));
+    // The rounding of the final shift is folded into the offset.
+    __m256i sum = _mm256_set1_epi16(-kFirstPassOffset +
+                                    (1 << (kInterRoundBitsHorizontal - 1)));
+    // k = 0, 2.
+    sum = AccumulateFilter(sum, filter[0], filter[1], src_row_window);
+    // k = 1, 3.
+    src_row_window = _mm256_srli_si256(src_row_window, 1);
+    sum = AccumulateFilter(sum, _mm256_srli_si256(filter[0], 8),
+                           _mm256_srli_si256(filter[1], 8), src_row_window);
+    // k = 4, 6.
+    src_row_window = _mm256_srli_si256(src_row_window, 3);
+    sum = AccumulateFilter(sum, filter[2], filter[3], src_row_window);
+    // k = 5, 7.
+    src_row_window = _mm256_srli_si256(src_row_window, 1);
+    sum = AccumulateFilter(sum, _mm256_srli_si256(filter[2], 8),
+                           _mm256_srli_si256(filter[3], 8), src_row_window);
+    sum = _mm256_srai_epi16(sum, kInterRoundBitsHorizontal);
+
+    if (block[0].is_border) {
+      sum = _mm256_inserti128_si256(
+          sum,
+          _mm_set1_epi16(BorderRowValue(block[0].src[y * block[0].src_stride])),
+          0);
+    } else if (block[1].is_border) {
+      sum = _mm256_inserti128_si256(
+          sum,
+          _mm_set1_epi16(BorderRowValue(block[1].src[y * block[1].src_stride])),
+          1);
+    }
+    intermediate_result[y] = sum;
+    position_lo = _mm256_add_epi32(position_lo, position_step);
+    position_hi = _mm256_add_epi32(position_hi, position_step);
+  }
+}
+
+// Applies the vertical filter to the horizontal filter output of both blocks
+// and stores the output of block i to |dst[i]|.
+template <bool is_compound, typename DestType>
+inline void VerticalFilter(const __m256i intermediate_result[15],
+                           const WarpBlock block[2], const int gamma,
+                           const int delta, DestType* dst_0, DestType* dst_1,
+                           const ptrdiff_t dest_stride) {
+  constexpr int kRoundBitsVertical =
+      is_compound ? kInterRoundBitsCompoundVertical : kInterRoundBitsVertical;
+  // Adjacent rows of the horizontal filter output, interleaved for
+  // _mm256_madd_epi16(). Columns 0 to 3 are in |intermediate_low| and columns
+  // 4 to 7 in |intermediate_high|.
+  __m256i intermediate_low[14];
+  __m256i intermediate_high[14];
+  for (int k = 0; k < 14; ++k) {
+    intermediate_low[k] = _mm256_unpacklo_epi16(intermediate_result[k],
+                                                 intermediate_result[k + 1]);
+    intermediate_high[k] = _mm256_unpackhi_epi16(intermediate_result[k],
+                                                  intermediate_result[k + 1]);
+  }
+  __m256i position_lo = FilterPositions(
+      (block[0].y4 & ((1 << kWarpedModelPrecisionBits) - 1)) -
+          MultiplyBy4(delta),
+      (block[1].y4 & ((1 << kWarpedModelPrecisionBits) - 1)) -
+          MultiplyBy4(delta),
+      gamma);
+  __m256i position_hi =
+      _mm256_add_epi32(position_lo, _mm256_set1_epi32(4 * gamma));
+  const __m256i position_step = _mm256_set1_epi32(delta);
+  const __m256i zero = _mm256_setzero_si256();
+  for (int y = 0; y < 8; ++y) {
+    const __m256i index_lo =
+        _mm256_srai_epi32(position_lo, kWarpedDiffPrecisionBits);
+    const __m256i index_hi =
+        _mm256_srai_epi32(position_hi, kWarpedDiffPrecisionBits);
+    const __m256i filters[4] = {
+        GatherFilters(_mm256_castsi256_si128(index_lo)),
+        GatherFilters(_mm256_extracti128_si256(index_lo, 1)),
+        GatherFilters(_mm256_castsi256_si128(index_hi)),
+        GatherFilters(_mm256_extracti128_si256(index_hi, 1))};
+    // Widen the filters of columns 0 to 7 to 16 bits.
+    __m256i f[8];
+    for (int i = 0; i < 4; ++i) {
+      const __m256i sign = _mm256_cmpgt_epi8(zero, filters[i]);
+      f[2 * i] = _mm256_unpacklo_epi8(filters[i], sign);
+      f[2 * i + 1] = _mm256_unpackhi_epi8(filters[i], sign);
+    }
+    // Taps k and k + 1 of a column are a 32-bit element of its filter, so a
+    // 4x4 transpose of 32-bit elements gives the taps of 4 columns arranged
+    // for _mm256_madd_epi16().
+    __m256i sum_low = _mm256_set1_epi32(kOffsetRemoval +
+                                        ((1 << kRoundBitsVertical) >> 1));
+    __m256i sum_high = sum_low;
+    for (int half = 0; half < 2; ++half) {
+      const __m256i* const c = &f[4 * half];
+      const __m256i t0 = _mm256_unpacklo_epi32(c[0], c[1]);
+      const __m256i t1 = _mm256_unpacklo_epi32(c[2], c[3]);
+      const __m256i t2 = _mm256_unpackhi_epi32(c[0], c[1]);
+      const __m256i t3 = _mm256_unpackhi_epi32(c[2], c[3]);
+      const __m256i taps[4] = {
+          _mm256_unpacklo_epi64(t0, t1), _mm256_unpackhi_epi64(t0, t1),
+          _mm256_unpacklo_epi64(t2, t3), _mm256_unpackhi_epi64(t2, t3)};
+      const __m256i* const intermediate =
+          (half == 0) ? intermediate_low : intermediate_high;
+      __m256i& sum = (half == 0) ? sum_low : sum_high;
+      for (int k = 0; k < 4; ++k) {
+        sum = _mm256_add_epi32(
+            sum, _mm256_madd_epi16(taps[k], intermediate[y + 2 * k]));
+      }
+    }
+    sum_low = _mm256_srai_epi32(sum_low, kRoundBitsVertical);
+    sum_high = _mm256_srai_epi32(sum_high, kRoundBitsVertical);
+    if (is_compound) {
+      const __m256i sum = _mm256_packs_epi32(sum_low, sum_high);
+      StoreUnaligned16(dst_0, _mm256_castsi256_si128(sum));
+      StoreUnaligned16(dst_1, _mm256_extracti128_si256(sum, 1));
+    } else {
+      const __m256i sum = _mm256_packus_epi32(sum_low, sum_high);
+      const __m256i result = _mm256_packus_epi16(sum, sum);
+      StoreLo8(dst_0, _mm256_castsi256_si128(result));
+      StoreLo8(dst_1, _mm256_extracti128_si256(result, 1));
+    }
+    dst_0 += dest_stride;
+    dst_1 += dest_stride;
+    position_lo = _mm256_add_epi32(position_lo, position_step);
+    position_hi = _mm256_add_epi32(position_hi, position_step);
+  }
+}
+
+template <bool is_compound>
+void Warp_AVX2(const void* source, ptrdiff_t source_stride, int source_width,
+               int source_height, const int* warp_params, int subsampling_x,
+               int subsampling_y, int block_start_x, int block_start_y,
+               int block_width, int block_height, int16_t alpha, int16_t beta,
+               int16_t gamma, int16_t delta, void* dest,
+               ptrdiff_t dest_stride) {
+  const auto* const src = static_cast<const uint8_t*>(source);
+  using DestType =
+      typename std::conditional<is_compound, int16_t, uint8_t>::type;
+  auto* const dst = static_cast<DestType*>(dest);
+
+  // Warp process applies for each 8x8 block. The 8x8 blocks are processed in
+  // pairs of horizontally adjacent blocks, or vertically adjacent blocks if
+  // the block is 8 pixels wide. An 8x8 block is paired with itself.
+  assert(block_width >= 8);
+  assert(block_height >= 8);
+  const int pair_x = (block_width >= 16) ? 8 : 0;
+  const int pair_y = (pair_x == 0 && block_height >= 16) ? 8 : 0;
+  const ptrdiff_t pair_offset = pair_x + pair_y * dest_stride;
+  int y = 0;
+  do {
+    const int src_y = (block_start_y + y + 4) << subsampling_y;
+    DestType* dst_row = dst + y * dest_stride;
+    int x = 0;
+    do {
+      const int src_x = (block_start_x + x + 4) << subsampling_x;
+      WarpBlock block[2];
+      SetupWarpBlock(src, source_stride, source_width, source_height,
+                     warp_params, subsampling_x, subsampling_y, src_x, src_y,
+                     &block[0]);
+      SetupWarpBlock(src, source_stride, source_width, source_height,
+                     warp_params, subsampling_x, subsampling_y,
+                     src_x + (pair_x << subsampling_x),
+                     src_y + (pair_y << subsampling_y), &block[1]);
+      __m256i intermediate_result[15];
+      HorizontalFilter(block, alpha, beta, intermediate_result);
+      VerticalFilter<is_compound>(intermediate_result, block, gamma, delta,
+                                  dst_row + x, dst_row + x + pair_offset,
+                                  dest_stride);
+      x += 8 + pair_x;
+    } while (x < block_width);
+    y += 8 + pair_y;
+  } while (y < block_height);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX2(Warp)
+  dsp->warp = Warp_AVX2</*is_compound=*/false>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WarpCompound)
+  dsp->warp_compound = Warp_AVX2</*is_compound=*/true>;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+void WarpInit_AVX2() { low_bitdepth::Init8bpp(); }
+
+}  // namespace dsp
+}  // namespace libgav1
+#else  // !LIBGAV1_TARGETING_AVX2
+
+namespace libgav1 {
+namespace dsp {
+
+void WarpInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
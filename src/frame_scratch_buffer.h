@@ -44,15 +44,29 @@ namespace libgav1 {
 using IntraPredictionBuffer =
     std::array<AlignedDynamicBuffer<uint8_t, kMaxAlignment>, kMaxPlanes>;
 
+// Deblock filter parameters of the left (kLoopFilterTypeVertical) and top
+// (kLoopFilterTypeHorizontal) edges of each 4x4 block, in luma 4x4 units. They
+// are filled in by the tiles as the blocks are parsed (see
+// PostFilter::StoreDeblockFilterEdges()) and read by the deblocking filter.
+struct DeblockFilterEdges {
+  // Indexed by the loop filter type and the plane. A level of 0 means that the
+  // edge is not filtered.
+  Array2D<uint8_t> levels[kNumLoopFilterTypes][kMaxPlanes];
+  // Indexed by the loop filter type and the plane type.
+  Array2D<uint8_t> filter_lengths[kNumLoopFilterTypes][kNumPlaneTypes];
+};
+
 // Buffer to facilitate decoding a frame. This struct is used only within
 // DecoderImpl::DecodeTiles().
 struct FrameScratchBuffer {
   LoopRestorationInfo loop_restoration_info;
   Array2D<int16_t> cdef_index;
   Array2D<TransformSize> inter_transform_sizes;
+  DeblockFilterEdges deblock_filter_edges;
   BlockParametersHolder block_parameters_holder;
   TemporalMotionField motion_field;
-  SymbolDecoderContext symbol_decoder_context;
+  // The CDF tables at the start of the frame. Each tile makes its own copy.
+  SymbolDecoderContextPtr symbol_decoder_context;
   std::unique_ptr<ResidualBufferPool> residual_buffer_pool;
   // Buffer used to store the cdef borders. This buffer will store 4 rows for
   // every 64x64 block (4 rows for every 32x32 for chroma with subsampling). The
@@ -66,6 +80,10 @@ struct FrameScratchBuffer {
   // subsampling). The indices of the rows that are stored are specified in
   // |kLoopRestorationBorderRows|.
   YuvBuffer loop_restoration_border;
+  // Buffer used to hold the filtered loop restoration units of one row before
+  // they are copied in place. It has kRestorationUnitHeight rows for each
+  // thread that applies loop restoration.
+  YuvBuffer loop_restoration_unit_buffer;
   // The size of this dynamic buffer is |tile_rows|.
   DynamicBuffer<IntraPredictionBuffer> intra_prediction_buffers;
   TileScratchBufferPool tile_scratch_buffer_pool;
@@ -89,9 +89,10 @@ class LIBGAV1_PUBLIC Decoder {
   // field of the DecoderBuffer returned by the corresponding |DequeueFrame()|
   // call.
   //
-  // NOTE: |EnqueueFrame()| does not copy the data. Therefore, after a
-  // successful |EnqueueFrame()| call, the caller must keep the |data| buffer
-  // alive until:
+  // NOTE: |EnqueueFrame()| does not copy the data. The tile data is decoded
+  // directly from |data|, and must not be modified while the decoder holds a
+  // reference to it. Therefore, after a successful |EnqueueFrame()| call, the
+  // caller must keep the |data| buffer alive and unchanged until:
   // 1) If |settings_.release_input_buffer| is not nullptr, then |data| buffer
   // must be kept alive until release_input_buffer is called with the
   // |buffer_private_data| passed into this EnqueueFrame call.
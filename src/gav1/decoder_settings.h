@@ -40,6 +40,19 @@ extern "C" {
 typedef void (*Libgav1ReleaseInputBufferCallback)(void* callback_private_data,
                                                   void* buffer_private_data);
 
+// A job of the decoder. |job_private_data| is the value passed to the
+// Libgav1ScheduleJobCallback call.
+typedef void (*Libgav1JobFunction)(void* job_private_data);
+
+// This callback is invoked by the decoder to run its multi-threaded work on the
+// threads of the application instead of its own threads. The application must
+// call job(job_private_data) exactly once, on any thread, but not from within
+// this callback. The jobs do not block, except that the decoder instance is not
+// destroyed until all of its jobs have returned.
+typedef void (*Libgav1ScheduleJobCallback)(void* callback_private_data,
+                                           Libgav1JobFunction job,
+                                           void* job_private_data);
+
 typedef struct Libgav1DecoderSettings {
   // Number of threads to use when decoding. Must be greater than 0. The library
   // will create at most |threads| new threads. Defaults to 1 (no new threads
@@ -82,6 +95,69 @@ typedef struct Libgav1DecoderSettings {
   //   Bit 4: Film grain synthesis.
   //   All the bits other than the last 5 are ignored.
   uint8_t post_filter_mask;
+  // A boolean. If set to 1, only the key frames are decoded and output. The
+  // headers of all the other frames are still parsed (so that the reference
+  // state remains valid), but their tiles are not decoded, no post filters are
+  // run on them and they are never output. This gets to the next random access
+  // point without decoding the frames in between, which is useful for
+  // extracting thumbnails. Use post_filter_mask to further reduce the cost of
+  // the decoded key frames.
+  int key_frames_only;
+  // Mask indicating the post processing filters that may be applied to the
+  // inter frames. It uses the same bits as post_filter_mask, and a filter is
+  // applied to an inter frame only if it is enabled in both masks. Note this is
+  // an advanced setting and does not typically need to be changed.
+  uint8_t inter_post_filter_mask;
+  // Approximate preview decoding, which is not conformant. Must be 0, 1 or 2.
+  // If nonzero, the reconstruction of every transform block only uses the
+  // coefficients in the top-left 1 / (1 << preview_scale_log2) of each
+  // dimension, and the output frames are downscaled by
+  // (1 << preview_scale_log2) in each dimension. The errors propagate through
+  // inter prediction until the next key frame. Defaults to 0 (off).
+  int preview_scale_log2;
+  // A boolean. If set to 1, the decoder does not create its own worker
+  // threads. Instead, the jobs of all the decoders created with this setting
+  // (tile, superblock row, post filter and film grain jobs) are run by one
+  // thread pool that is shared by the whole process. This avoids creating
+  // threads * N threads when N streams are decoded at the same time. The shared
+  // pool is created by the first such decoder with threads - 1 worker threads
+  // and is never destroyed. The threads setting of each decoder still controls
+  // how its work is divided into jobs. The jobs are run in the order in which
+  // they were scheduled and the calling thread of each decoder also works on
+  // its own jobs, so every stream makes progress. frame_parallel is ignored
+  // when this is set to 1.
+  int shared_thread_pool;
+  // Schedule job callback. If not NULL and threads is greater than 1, the
+  // decoder does not create any threads and runs its tile, superblock row,
+  // post filter and film grain jobs using this callback instead. The threads
+  // setting is the number of threads the jobs may be expected to run on,
+  // including the thread that calls the decoder. This lets the application
+  // control the affinity and the priority of the threads doing the decoding.
+  // frame_parallel and shared_thread_pool are ignored when this is not NULL.
+  Libgav1ScheduleJobCallback schedule_job;
+  // A boolean. If set to 1, the pages of the frame buffers allocated by the
+  // library are interleaved across all the NUMA nodes (Linux only). The jobs of
+  // a frame are spread over all the threads dynamically, so on a multi-socket
+  // machine this balances the memory bandwidth over all the memory controllers
+  // instead of using the node of whichever thread touched the page first.
+  // Frame buffers returned by get_frame_buffer and the scratch buffers of the
+  // decoder are not affected.
+  int interleave_numa_nodes;
+  // A boolean. If set to 1, the frame buffers allocated by the library are
+  // backed by 2 MiB huge pages when possible (Linux only). Explicit huge pages
+  // are used if enough of them are reserved, and transparent huge pages
+  // otherwise. This reduces the TLB misses of the reference frame reads in
+  // inter prediction for large frames. Frame buffers returned by
+  // get_frame_buffer are not affected.
+  int use_huge_pages;
+  // A boolean. If set to 1 and frame_parallel is 0, a frame with a single tile
+  // that is followed by other frames in the same temporal unit is
+  // reconstructed and post filtered on a dedicated thread, while the symbols
+  // of the next frame are parsed on the calling thread. This overlaps the
+  // entropy decoding, which is serial within a tile, with the reconstruction
+  // of the frames that precede it (typically the hidden alternate reference
+  // frames). The dedicated thread is created in addition to threads.
+  int parse_ahead;
 } Libgav1DecoderSettings;
 
 LIBGAV1_PUBLIC void Libgav1DecoderSettingsInitDefault(
@@ -93,6 +169,8 @@ LIBGAV1_PUBLIC void Libgav1DecoderSettingsInitDefault(
 namespace libgav1 {
 
 using ReleaseInputBufferCallback = Libgav1ReleaseInputBufferCallback;
+using JobFunction = Libgav1JobFunction;
+using ScheduleJobCallback = Libgav1ScheduleJobCallback;
 
 // Applications must populate this structure before creating a decoder instance.
 struct DecoderSettings {
@@ -137,6 +215,70 @@ struct DecoderSettings {
   //   Bit 4: Film grain synthesis.
   //   All the bits other than the last 5 are ignored.
   uint8_t post_filter_mask = 0x1f;
+  // If set to true, only the key frames are decoded and output. The headers of
+  // all the other frames are still parsed (so that the reference state remains
+  // valid), but their tiles are not decoded, no post filters are run on them
+  // and they are never output. This gets to the next random access point
+  // without decoding the frames in between, which is useful for extracting
+  // thumbnails. Use |post_filter_mask| to further reduce the cost of the
+  // decoded key frames.
+  bool key_frames_only = false;
+  // Mask indicating the post processing filters that may be applied to the
+  // inter frames. It uses the same bits as |post_filter_mask|, and a filter is
+  // applied to an inter frame only if it is enabled in both masks. Note this is
+  // an advanced setting and does not typically need to be changed.
+  uint8_t inter_post_filter_mask = 0x1f;
+  // Approximate preview decoding, which is not conformant. Must be 0, 1 or 2.
+  // If nonzero, the reconstruction of every transform block only uses the
+  // coefficients in the top-left 1 / (1 << |preview_scale_log2|) of each
+  // dimension, and the output frames are downscaled by
+  // (1 << |preview_scale_log2|) in each dimension. The errors propagate
+  // through inter prediction until the next key frame. Defaults to 0 (off).
+  int preview_scale_log2 = 0;
+  // If set to true, the decoder does not create its own worker threads.
+  // Instead, the jobs of all the decoders created with this setting (tile,
+  // superblock row, post filter and film grain jobs) are run by one thread pool
+  // that is shared by the whole process. This avoids creating |threads| * N
+  // threads when N streams are decoded at the same time. The shared pool is
+  // created by the first such decoder with |threads| - 1 worker threads and is
+  // never destroyed. The |threads| setting of each decoder still controls how
+  // its work is divided into jobs. The jobs are run in the order in which they
+  // were scheduled and the calling thread of each decoder also works on its own
+  // jobs, so every stream makes progress. |frame_parallel| is ignored when this
+  // is set to true.
+  bool shared_thread_pool = false;
+  // Schedule job callback. If not nullptr and |threads| is greater than 1, the
+  // decoder does not create any threads and runs its tile, superblock row,
+  // post filter and film grain jobs using this callback instead. |threads| is
+  // the number of threads the jobs may be expected to run on, including the
+  // thread that calls the decoder. This lets the application control the
+  // affinity and the priority of the threads doing the decoding.
+  // |frame_parallel| and |shared_thread_pool| are ignored when this is not
+  // nullptr.
+  ScheduleJobCallback schedule_job = nullptr;
+  // If set to true, the pages of the frame buffers allocated by the library are
+  // interleaved across all the NUMA nodes (Linux only). The jobs of a frame are
+  // spread over all the threads dynamically, so on a multi-socket machine this
+  // balances the memory bandwidth over all the memory controllers instead of
+  // using the node of whichever thread touched the page first. Frame buffers
+  // returned by |get_frame_buffer| and the scratch buffers of the decoder are
+  // not affected.
+  bool interleave_numa_nodes = false;
+  // If set to true, the frame buffers allocated by the library are backed by
+  // 2 MiB huge pages when possible (Linux only). Explicit huge pages are used
+  // if enough of them are reserved, and transparent huge pages otherwise. This
+  // reduces the TLB misses of the reference frame reads in inter prediction
+  // for large frames. Frame buffers returned by |get_frame_buffer| are not
+  // affected.
+  bool use_huge_pages = false;
+  // If set to true and |frame_parallel| is false, a frame with a single tile
+  // that is followed by other frames in the same temporal unit is
+  // reconstructed and post filtered on a dedicated thread, while the symbols
+  // of the next frame are parsed on the calling thread. This overlaps the
+  // entropy decoding, which is serial within a tile, with the reconstruction
+  // of the frames that precede it (typically the hidden alternate reference
+  // frames). The dedicated thread is created in addition to |threads|.
+  bool parse_ahead = false;
 };
 
 }  // namespace libgav1
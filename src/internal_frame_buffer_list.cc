@@ -14,6 +14,11 @@
 
 #include "src/internal_frame_buffer_list.h"
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include <cassert>
 #include <cstdint>
 #include <memory>
@@ -21,6 +26,7 @@
 #include <utility>
 
 #include "src/utils/common.h"
+#include "src/utils/numa.h"
 
 namespace libgav1 {
 extern "C" {
@@ -95,11 +101,32 @@ StatusCode InternalFrameBufferList::GetFrameBuffer(
   }
 
   if (buffer->size < min_size) {
-    std::unique_ptr<uint8_t[], MallocDeleter> new_data(
-        static_cast<uint8_t*>(malloc(min_size)));
-    if (new_data == nullptr) return kStatusOutOfMemory;
+    // Free the old buffer first so that its memory can be reused.
+    buffer->data = nullptr;
+    buffer->size = 0;
+    size_t size = min_size;
+    BufferData new_data;
+    if (use_huge_pages_) new_data = AllocateHugePages(&size);
+    // The NUMA policy is only set on a mapping of our own. Memory from
+    // malloc() may reuse heap pages that were already touched, and the policy
+    // would also apply to the other allocations that share its pages.
+    if (new_data == nullptr && interleave_numa_nodes_) {
+      new_data = AllocatePages(&size);
+    }
+    if (new_data != nullptr) {
+      // The mapping has not been touched yet, so all of its pages are placed
+      // by the policy. A failure is not fatal since it only affects the
+      // placement of the pages.
+      if (interleave_numa_nodes_) {
+        InterleaveAcrossNumaNodes(new_data.get(), size);
+      }
+    } else {
+      size = min_size;
+      new_data.reset(static_cast<uint8_t*>(malloc(size)));
+      if (new_data == nullptr) return kStatusOutOfMemory;
+    }
     buffer->data = std::move(new_data);
-    buffer->size = min_size;
+    buffer->size = size;
   }
 
   uint8_t* const y_buffer = buffer->data.get();
@@ -114,6 +141,104 @@ StatusCode InternalFrameBufferList::GetFrameBuffer(
   return kStatusOk;
 }
 
+void InternalFrameBufferList::BufferDeleter::operator()(
+    uint8_t* const data) const {
+  if (mapped_size_ == 0) {
+    free(data);
+    return;
+  }
+#if defined(__linux__)
+  const int result = munmap(data, mapped_size_);
+  assert(result == 0);
+  static_cast<void>(result);
+#else
+  assert(false);
+#endif
+}
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+
+// static
+InternalFrameBufferList::BufferData InternalFrameBufferList::AllocateHugePages(
+    size_t* const size) {
+  constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+  if (*size > SIZE_MAX - 2 * kHugePageSize) return nullptr;
+  const size_t mapped_size = Align(*size, kHugePageSize);
+  void* data;
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+  // Try the explicit huge pages first. The mapping fails right away if not
+  // enough of them are reserved. The page size is requested explicitly since
+  // the default one may be larger than |kHugePageSize|, which would round the
+  // mapping up and break the munmap() of |mapped_size| bytes.
+#if defined(MAP_HUGE_2MB)
+  constexpr int kHugePageSizeFlag = MAP_HUGE_2MB;
+#else
+  constexpr int kHugePageSizeFlag = 21 << MAP_HUGE_SHIFT;
+#endif
+  static_assert(kHugePageSize == size_t{1} << 21, "");
+  data = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | kHugePageSizeFlag,
+              -1, 0);
+  if (data != MAP_FAILED) {
+    *size = mapped_size;
+    return BufferData(static_cast<uint8_t*>(data), BufferDeleter(mapped_size));
+  }
+#endif
+  // Transparent huge pages are only used for the parts of a mapping that are
+  // aligned to the huge page size, so map an extra huge page and trim the
+  // unaligned head and tail.
+  const size_t padded_size = mapped_size + kHugePageSize;
+  data = mmap(nullptr, padded_size, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED) return nullptr;
+  auto* const start = static_cast<uint8_t*>(data);
+  auto* const aligned_start = AlignAddr(start, kHugePageSize);
+  const size_t head = aligned_start - start;
+  if (head != 0) munmap(start, head);
+  munmap(aligned_start + mapped_size, kHugePageSize - head);
+  // Huge pages are only a hint. The memory is usable even if this fails.
+  madvise(aligned_start, mapped_size, MADV_HUGEPAGE);
+  *size = mapped_size;
+  return BufferData(aligned_start, BufferDeleter(mapped_size));
+}
+
+#else  // !(defined(__linux__) && defined(MADV_HUGEPAGE))
+
+// static
+InternalFrameBufferList::BufferData InternalFrameBufferList::AllocateHugePages(
+    size_t* /*size*/) {
+  return nullptr;
+}
+
+#endif  // defined(__linux__) && defined(MADV_HUGEPAGE)
+
+#if defined(__linux__)
+
+// static
+InternalFrameBufferList::BufferData InternalFrameBufferList::AllocatePages(
+    size_t* const size) {
+  const long page_size = sysconf(_SC_PAGESIZE);  // NOLINT(runtime/int)
+  if (page_size <= 0) return nullptr;
+  const auto alignment = static_cast<size_t>(page_size);
+  if (*size > SIZE_MAX - alignment) return nullptr;
+  const size_t mapped_size = Align(*size, alignment);
+  void* const data = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED) return nullptr;
+  *size = mapped_size;
+  return BufferData(static_cast<uint8_t*>(data), BufferDeleter(mapped_size));
+}
+
+#else  // !defined(__linux__)
+
+// static
+InternalFrameBufferList::BufferData InternalFrameBufferList::AllocatePages(
+    size_t* /*size*/) {
+  return nullptr;
+}
+
+#endif  // defined(__linux__)
+
 void InternalFrameBufferList::ReleaseFrameBuffer(void* buffer_private_data) {
   auto* const buffer = static_cast<Buffer*>(buffer_private_data);
   buffer->in_use = false;
@@ -43,6 +43,13 @@ extern "C" void ReleaseInternalFrameBuffer(void* callback_private_data,
 class InternalFrameBufferList : public Allocable {
  public:
   InternalFrameBufferList() = default;
+  // If |interleave_numa_nodes| is true, the frame buffers are allocated with
+  // their own memory mappings and their pages are interleaved across the NUMA
+  // nodes. See InterleaveAcrossNumaNodes(). If |use_huge_pages| is true, the
+  // frame buffers are backed by huge pages when possible.
+  InternalFrameBufferList(bool interleave_numa_nodes, bool use_huge_pages)
+      : interleave_numa_nodes_(interleave_numa_nodes),
+        use_huge_pages_(use_huge_pages) {}
 
   // Not copyable or movable.
   InternalFrameBufferList(const InternalFrameBufferList&) = delete;
@@ -67,13 +74,43 @@ class InternalFrameBufferList : public Allocable {
   void ReleaseFrameBuffer(void* buffer_private_data);
 
  private:
+  // Frees the memory returned by malloc() or, if |mapped_size| is not 0, the
+  // memory mapping of |mapped_size| bytes returned by AllocateHugePages() or
+  // AllocatePages().
+  class BufferDeleter {
+   public:
+    BufferDeleter() : mapped_size_(0) {}
+    explicit BufferDeleter(size_t mapped_size) : mapped_size_(mapped_size) {}
+    void operator()(uint8_t* data) const;
+
+   private:
+    size_t mapped_size_;
+  };
+
+  using BufferData = std::unique_ptr<uint8_t[], BufferDeleter>;
+
+  // Maps at least |*size| bytes of memory backed by huge pages, using explicit
+  // huge pages if the system has reserved them and transparent huge pages
+  // otherwise. On success, |*size| is updated to the size of the mapping, which
+  // is a multiple of the huge page size. Returns nullptr if huge pages are not
+  // supported or the mapping fails.
+  static BufferData AllocateHugePages(size_t* size);
+
+  // Maps at least |*size| bytes of anonymous memory that no other allocation
+  // shares. On success, |*size| is updated to the size of the mapping, which
+  // is a multiple of the page size. Returns nullptr if memory mappings are not
+  // supported or the mapping fails.
+  static BufferData AllocatePages(size_t* size);
+
   struct Buffer : public Allocable {
-    std::unique_ptr<uint8_t[], MallocDeleter> data;
+    BufferData data;
     size_t size = 0;
     bool in_use = false;
   };
 
   Vector<std::unique_ptr<Buffer>> buffers_;
+  const bool interleave_numa_nodes_ = false;
+  const bool use_huge_pages_ = false;
 };
 
 }  // namespace libgav1
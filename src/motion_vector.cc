@@ -16,12 +16,14 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <memory>
 
 #include "src/dsp/dsp.h"
 #include "src/utils/bit_mask_set.h"
+#include "src/utils/block_parameters_holder.h"
 #include "src/utils/common.h"
 #include "src/utils/constants.h"
 #include "src/utils/logging.h"
@@ -96,17 +98,12 @@ void SetupGlobalMv(const Tile::Block& block, int index,
   }
 }
 
-constexpr BitMaskSet kPredictionModeNewMvMask(kPredictionModeNewMv,
-                                              kPredictionModeNewNewMv,
-                                              kPredictionModeNearNewMv,
-                                              kPredictionModeNewNearMv,
-                                              kPredictionModeNearestNewMv,
-                                              kPredictionModeNewNearestMv);
-
-// 7.10.2.8.
-void SearchStack(const Tile::Block& block, const BlockParameters& mv_bp,
-                 int index, int weight, bool* const found_new_mv,
-                 bool* const found_match, int* const num_mv_found) {
+// 7.10.2.8. |mv_flags| and |mv_bp_mv| are the packed flags and motion vectors
+// of the candidate block (see BlockParametersHolder).
+void SearchStack(const Tile::Block& block, uint8_t mv_flags,
+                 const CompoundMotionVector& mv_bp_mv, int index, int weight,
+                 bool* const found_new_mv, bool* const found_match,
+                 int* const num_mv_found) {
   const BlockParameters& bp = *block.bp;
   const std::array<GlobalMotion, kNumReferenceFrameTypes>& global_motion =
       block.tile.frame_header().global_motion;
@@ -115,12 +112,13 @@ void SearchStack(const Tile::Block& block, const BlockParameters& mv_bp,
   // LowerMvPrecision() is not necessary, since the values in
   // |prediction_parameters.global_mv| and |mv_bp.mv| were generated by it.
   const auto global_motion_type = global_motion[bp.reference_frame[0]].type;
-  if (IsGlobalMvBlock(mv_bp.is_global_mv_block, global_motion_type)) {
+  if (IsGlobalMvBlock((mv_flags & kBlockParametersFlagIsGlobalMvBlock) != 0,
+                      global_motion_type)) {
     candidate_mv = prediction_parameters.global_mv[0];
   } else {
-    candidate_mv = mv_bp.mv.mv[index];
+    candidate_mv = mv_bp_mv.mv[index];
   }
-  *found_new_mv |= kPredictionModeNewMvMask.Contains(mv_bp.y_mode);
+  *found_new_mv |= (mv_flags & kBlockParametersFlagHasNewMv) != 0;
   *found_match = true;
   MotionVector* const ref_mv_stack = prediction_parameters.ref_mv_stack;
   const int num_found = *num_mv_found;
@@ -140,23 +138,26 @@ void SearchStack(const Tile::Block& block, const BlockParameters& mv_bp,
 }
 
 // 7.10.2.9.
-void CompoundSearchStack(const Tile::Block& block, const BlockParameters& mv_bp,
-                         int weight, bool* const found_new_mv,
-                         bool* const found_match, int* const num_mv_found) {
+void CompoundSearchStack(const Tile::Block& block, uint8_t mv_flags,
+                         const CompoundMotionVector& mv_bp_mv, int weight,
+                         bool* const found_new_mv, bool* const found_match,
+                         int* const num_mv_found) {
   const BlockParameters& bp = *block.bp;
   const std::array<GlobalMotion, kNumReferenceFrameTypes>& global_motion =
       block.tile.frame_header().global_motion;
   PredictionParameters& prediction_parameters = *bp.prediction_parameters;
   // LowerMvPrecision() is not necessary, since the values in
   // |prediction_parameters.global_mv| and |mv_bp.mv| were generated by it.
-  CompoundMotionVector candidate_mv = mv_bp.mv;
+  CompoundMotionVector candidate_mv = mv_bp_mv;
+  const bool is_global_mv_block =
+      (mv_flags & kBlockParametersFlagIsGlobalMvBlock) != 0;
   for (int i = 0; i < 2; ++i) {
     const auto global_motion_type = global_motion[bp.reference_frame[i]].type;
-    if (IsGlobalMvBlock(mv_bp.is_global_mv_block, global_motion_type)) {
+    if (IsGlobalMvBlock(is_global_mv_block, global_motion_type)) {
       candidate_mv.mv[i] = prediction_parameters.global_mv[i];
     }
   }
-  *found_new_mv |= kPredictionModeNewMvMask.Contains(mv_bp.y_mode);
+  *found_new_mv |= (mv_flags & kBlockParametersFlagHasNewMv) != 0;
   *found_match = true;
   CompoundMotionVector* const compound_ref_mv_stack =
       prediction_parameters.compound_ref_mv_stack;
@@ -177,26 +178,35 @@ void CompoundSearchStack(const Tile::Block& block, const BlockParameters& mv_bp,
   ++*num_mv_found;
 }
 
-// 7.10.2.7.
+// 7.10.2.7. |offset| is the offset of the candidate block in the packed
+// planes of |holder|.
 void AddReferenceMvCandidate(const Tile::Block& block,
-                             const BlockParameters& mv_bp, bool is_compound,
-                             int weight, bool* const found_new_mv,
-                             bool* const found_match, int* const num_mv_found) {
-  if (!mv_bp.is_inter) return;
+                             const BlockParametersHolder& holder,
+                             ptrdiff_t offset, bool is_compound, int weight,
+                             bool* const found_new_mv, bool* const found_match,
+                             int* const num_mv_found) {
+  const uint8_t mv_flags = holder.flags()[offset];
+  if ((mv_flags & kBlockParametersFlagIsInter) == 0) return;
   const BlockParameters& bp = *block.bp;
+  const ReferenceFrameType mv_reference_frame_0 =
+      holder.reference_frames(0)[offset];
+  const ReferenceFrameType mv_reference_frame_1 =
+      holder.reference_frames(1)[offset];
   if (is_compound) {
-    if (mv_bp.reference_frame[0] == bp.reference_frame[0] &&
-        mv_bp.reference_frame[1] == bp.reference_frame[1]) {
-      CompoundSearchStack(block, mv_bp, weight, found_new_mv, found_match,
-                          num_mv_found);
+    if (mv_reference_frame_0 == bp.reference_frame[0] &&
+        mv_reference_frame_1 == bp.reference_frame[1]) {
+      CompoundSearchStack(block, mv_flags, holder.mvs()[offset], weight,
+                          found_new_mv, found_match, num_mv_found);
     }
     return;
   }
-  for (int i = 0; i < 2; ++i) {
-    if (mv_bp.reference_frame[i] == bp.reference_frame[0]) {
-      SearchStack(block, mv_bp, i, weight, found_new_mv, found_match,
-                  num_mv_found);
-    }
+  if (mv_reference_frame_0 == bp.reference_frame[0]) {
+    SearchStack(block, mv_flags, holder.mvs()[offset], 0, weight, found_new_mv,
+                found_match, num_mv_found);
+  }
+  if (mv_reference_frame_1 == bp.reference_frame[0]) {
+    SearchStack(block, mv_flags, holder.mvs()[offset], 1, weight, found_new_mv,
+                found_match, num_mv_found);
   }
 }
 
@@ -216,19 +226,21 @@ void ScanRow(const Tile::Block& block, int mv_column, int delta_row,
   if (!tile.IsTopInside(mv_row + 1)) return;
   const int width4x4 = block.width4x4;
   const int min_step = GetMinimumStep(width4x4, delta_row);
-  BlockParameters** bps = tile.BlockParametersAddress(mv_row, mv_column);
-  BlockParameters** const end_bps =
-      bps + std::min({static_cast<int>(width4x4),
-                      tile.frame_header().columns4x4 - block.column4x4, 16});
+  const BlockParametersHolder& holder = tile.block_parameters_holder();
+  const BlockSize* const sizes = holder.sizes();
+  ptrdiff_t offset = holder.Offset(mv_row, mv_column);
+  const ptrdiff_t end_offset =
+      offset + std::min({static_cast<int>(width4x4),
+                         tile.frame_header().columns4x4 - block.column4x4, 16});
   do {
-    const BlockParameters& mv_bp = **bps;
     const int step = std::max(
-        std::min(width4x4, static_cast<int>(kNum4x4BlocksWide[mv_bp.size])),
+        std::min(width4x4, static_cast<int>(kNum4x4BlocksWide[sizes[offset]])),
         min_step);
-    AddReferenceMvCandidate(block, mv_bp, is_compound, MultiplyBy2(step),
-                            found_new_mv, found_match, num_mv_found);
-    bps += step;
-  } while (bps < end_bps);
+    AddReferenceMvCandidate(block, holder, offset, is_compound,
+                            MultiplyBy2(step), found_new_mv, found_match,
+                            num_mv_found);
+    offset += step;
+  } while (offset < end_offset);
 }
 
 // 7.10.2.3.
@@ -240,20 +252,23 @@ void ScanColumn(const Tile::Block& block, int mv_row, int delta_column,
   if (!tile.IsLeftInside(mv_column + 1)) return;
   const int height4x4 = block.height4x4;
   const int min_step = GetMinimumStep(height4x4, delta_column);
-  const ptrdiff_t stride = tile.BlockParametersStride();
-  BlockParameters** bps = tile.BlockParametersAddress(mv_row, mv_column);
-  BlockParameters** const end_bps =
-      bps + stride * std::min({static_cast<int>(height4x4),
-                               tile.frame_header().rows4x4 - block.row4x4, 16});
+  const BlockParametersHolder& holder = tile.block_parameters_holder();
+  const BlockSize* const sizes = holder.sizes();
+  const ptrdiff_t stride = holder.columns4x4();
+  ptrdiff_t offset = holder.Offset(mv_row, mv_column);
+  const ptrdiff_t end_offset =
+      offset +
+      stride * std::min({static_cast<int>(height4x4),
+                         tile.frame_header().rows4x4 - block.row4x4, 16});
   do {
-    const BlockParameters& mv_bp = **bps;
     const int step = std::max(
-        std::min(height4x4, static_cast<int>(kNum4x4BlocksHigh[mv_bp.size])),
+        std::min(height4x4, static_cast<int>(kNum4x4BlocksHigh[sizes[offset]])),
         min_step);
-    AddReferenceMvCandidate(block, mv_bp, is_compound, MultiplyBy2(step),
-                            found_new_mv, found_match, num_mv_found);
-    bps += step * stride;
-  } while (bps < end_bps);
+    AddReferenceMvCandidate(block, holder, offset, is_compound,
+                            MultiplyBy2(step), found_new_mv, found_match,
+                            num_mv_found);
+    offset += step * stride;
+  } while (offset < end_offset);
 }
 
 // 7.10.2.4.
@@ -267,9 +282,10 @@ void ScanPoint(const Tile::Block& block, int delta_row, int delta_column,
       !tile.HasParameters(mv_row, mv_column)) {
     return;
   }
-  const BlockParameters& mv_bp = tile.Parameters(mv_row, mv_column);
-  if (mv_bp.reference_frame[0] == kReferenceFrameNone) return;
-  AddReferenceMvCandidate(block, mv_bp, is_compound, 4, found_new_mv,
+  const BlockParametersHolder& holder = tile.block_parameters_holder();
+  const ptrdiff_t offset = holder.Offset(mv_row, mv_column);
+  if (holder.reference_frames(0)[offset] == kReferenceFrameNone) return;
+  AddReferenceMvCandidate(block, holder, offset, is_compound, 4, found_new_mv,
                           found_match, num_mv_found);
 }
 
@@ -938,6 +954,16 @@ void SetupMotionField(
   const int x8_start = DivideBy2(column4x4_start);
   const int x8_end =
       DivideBy2(std::min(column4x4_end, frame_header.columns4x4));
+  // For each motion vector, only mv[0] needs to be initialized to
+  // kInvalidMvValue, mv[1] is not necessary to be initialized and can be set to
+  // an arbitrary value. For simplicity, mv[1] is set to 0.
+  MotionVector invalid_mv;
+  invalid_mv.mv[0] = kInvalidMvValue;
+  invalid_mv.mv[1] = 0;
+  for (int y8 = y8_start; y8 < y8_end; ++y8) {
+    MotionVector* const mv = motion_field->mv[y8];
+    std::fill(mv + x8_start, mv + x8_end, invalid_mv);
+  }
   const int last_index = frame_header.reference_frame_index[0];
   const ReferenceInfo& reference_info = *current_frame.reference_info();
   if (!IsIntraFrame(reference_frames[last_index]->frame_type())) {
@@ -45,8 +45,10 @@ void FindWarpSamples(const Tile::Block& block, int* num_warp_samples,
                      int* num_samples_scanned,
                      int candidates[kMaxLeastSquaresSamples][4]);  // 7.10.4.
 
-// Section 7.9.1 in the spec. But this is done per tile instead of for the whole
-// frame.
+// Section 7.9.1 in the spec. But this is done for a block of rows and columns
+// (a superblock row of a tile) instead of for the whole frame. The rows of the
+// block must start at a multiple of 16 (i.e. 64 luma samples) since projected
+// motion vectors never cross such a row boundary.
 void SetupMotionField(
     const ObuFrameHeader& frame_header, const RefCountedBuffer& current_frame,
     const std::array<RefCountedBufferPtr, kNumReferenceFrameTypes>&
@@ -111,11 +111,11 @@ class PostFilter {
   //             |superres_line_buffer_| as the input and the output is written
   //             into |superres_buffer_| (which is just |cdef_buffer_| with a
   //             shift to the top).
-  // * Restoration: Near in-place filtering.
+  // * Restoration: In-place filtering.
   //                Uses the |superres_buffer_| and |loop_restoration_border_|
   //                as the input and the output is written into
-  //                |loop_restoration_buffer_| (which is just |superres_buffer_|
-  //                with a shift to the left).
+  //                |loop_restoration_buffer_| (which is the same as
+  //                |superres_buffer_|) through |loop_restoration_unit_buffer_|.
   void ApplyFilteringThreaded();
 
   // Does the overall post processing filter for one superblock row starting at
@@ -132,11 +132,12 @@ class PostFilter {
   // * SuperRes: Near in-place filtering. Uses the |cdef_buffer_| as the input
   //             and the output is written into |superres_buffer_| (which is
   //             just |cdef_buffer_| with a shift to the top).
-  // * Restoration: Near in-place filtering.
+  // * Restoration: In-place filtering if cdef is on, near in-place otherwise.
   //                Uses the |superres_buffer_| and |loop_restoration_border_|
-  //                as the input and the output is written into
-  //                |loop_restoration_buffer_| (which is just |superres_buffer_|
-  //                with a shift to the left or top-left).
+  //                (only if cdef is on) as the input and the output is
+  //                written into |loop_restoration_buffer_| (which is the same
+  //                as |superres_buffer_| if cdef is on, and |superres_buffer_|
+  //                with a shift to the top-left otherwise).
   // Returns the index of the last row whose post processing is complete and can
   // be used for referencing.
   int ApplyFilteringForOneSuperBlockRow(int row4x4, int sb4x4, bool is_last_row,
@@ -151,6 +152,17 @@ class PostFilter {
   void ApplyDeblockFilter(LoopFilterType loop_filter_type, int row4x4_start,
                           int column4x4_start, int column4x4_end, int sb4x4);
 
+  // Computes the deblock filter levels and filter lengths of the edges of the
+  // block at |row4x4|, |column4x4| of size |block_size| (the transform edges
+  // inside it and its left and top borders) and stores them into
+  // |deblock_filter_edges_|. It must be called once the block has been parsed.
+  // The edges on the left and top borders of the tile (that starts at
+  // |tile_row4x4_start|, |tile_column4x4_start|) depend on blocks of other
+  // tiles, which may still be being parsed. Those are marked so that the
+  // deblocking filter computes them itself.
+  void StoreDeblockFilterEdges(int row4x4, int column4x4, BlockSize block_size,
+                               int tile_row4x4_start, int tile_column4x4_start);
+
   static bool DoCdef(const ObuFrameHeader& frame_header,
                      int do_post_filter_mask) {
     return (frame_header.cdef.bits > 0 ||
@@ -324,12 +336,12 @@ class PostFilter {
                                             uint8_t* level_u, uint8_t* level_v,
                                             int* step,
                                             int* filter_length) const;
+  // |offset| is the offset of the current block in the packed planes of
+  // |block_parameters_| (see BlockParametersHolder::Offset()).
   bool GetVerticalDeblockFilterEdgeInfo(int row4x4, int column4x4,
-                                        BlockParameters* const* bp_ptr,
-                                        uint8_t* level, int* step,
-                                        int* filter_length) const;
-  void GetVerticalDeblockFilterEdgeInfoUV(int column4x4,
-                                          BlockParameters* const* bp_ptr,
+                                        ptrdiff_t offset, uint8_t* level,
+                                        int* step, int* filter_length) const;
+  void GetVerticalDeblockFilterEdgeInfoUV(int column4x4, ptrdiff_t offset,
                                           uint8_t* level_u, uint8_t* level_v,
                                           int* step, int* filter_length) const;
   void HorizontalDeblockFilter(int row4x4_start, int column4x4_start);
@@ -444,17 +456,22 @@ class PostFilter {
   // respectively. The second row is 64x64, 64x64, 12x64.
   // The third row is 64x20, 64x20, 12x20.
 
-  // |stride| is shared by |src_buffer| and |dst_buffer|.
+  // |stride| is shared by |src_buffer|, |dst_buffer| and |unit_buffer|.
+  // |unit_buffer| holds the filtered units until they are copied to
+  // |dst_buffer| when the filtering is done in place. It is nullptr otherwise.
   template <typename Pixel>
   void ApplyLoopRestorationForOneRow(const Pixel* src_buffer, ptrdiff_t stride,
                                      Plane plane, int plane_height,
                                      int plane_width, int y, int unit_row,
                                      int current_process_unit_height,
-                                     int plane_unit_size, Pixel* dst_buffer);
+                                     int plane_unit_size, Pixel* dst_buffer,
+                                     Pixel* unit_buffer);
   // Applies loop restoration for the superblock row starting at |row4x4_start|
-  // with a height of 4*|sb4x4|.
+  // with a height of 4*|sb4x4|. |unit_buffer_index| selects the rows of
+  // |loop_restoration_unit_buffer_| that are used.
   template <typename Pixel>
-  void ApplyLoopRestorationForOneSuperBlockRow(int row4x4_start, int sb4x4);
+  void ApplyLoopRestorationForOneSuperBlockRow(int row4x4_start, int sb4x4,
+                                               int unit_buffer_index);
   // Helper function that calls the right variant of
   // ApplyLoopRestorationForOneSuperBlockRow based on the bitdepth.
   void ApplyLoopRestoration(int row4x4_start, int sb4x4);
@@ -493,6 +510,7 @@ class PostFilter {
   } super_res_info_[kMaxPlanes];
   const Array2D<int16_t>& cdef_index_;
   const Array2D<TransformSize>& inter_transform_sizes_;
+  DeblockFilterEdges& deblock_filter_edges_;
   LoopRestorationInfo* const restoration_info_;
   uint8_t* const superres_coefficients_[kNumPlaneTypes];
   // Line buffer used by multi-threaded ApplySuperRes().
@@ -515,7 +533,8 @@ class PostFilter {
   // filter is applied (to facilitate in-place SuperRes).
   uint8_t* superres_buffer_[kMaxPlanes];
   // A view into |frame_buffer_| that points to the output of the Loop Restored
-  // planes (to facilitate in-place Loop Restoration).
+  // planes (to facilitate in-place Loop Restoration). It is the same as
+  // |superres_buffer_| when |loop_restoration_border_| is used.
   uint8_t* loop_restoration_buffer_[kMaxPlanes];
   YuvBuffer& cdef_border_;
   // Buffer used to store the border pixels that are necessary for loop
@@ -527,6 +546,15 @@ class PostFilter {
   //   (1). Loop Restoration is on.
   //   (2). Cdef is on, or multi-threading is enabled for post filter.
   YuvBuffer& loop_restoration_border_;
+  // Buffer that holds the output of the filtered loop restoration units of one
+  // row until they can be copied in place. Each worker thread uses its own
+  // |kRestorationUnitHeight| rows. The units that are not filtered are left
+  // where they are. This buffer is used under the same conditions as
+  // |loop_restoration_border_|.
+  YuvBuffer& loop_restoration_unit_buffer_;
+  // Number of workers that have started ApplyLoopRestorationWorker(). Used to
+  // give each worker its own rows of |loop_restoration_unit_buffer_|.
+  std::atomic<int> loop_restoration_workers_{0};
   const uint8_t do_post_filter_mask_;
   ThreadPool* const thread_pool_;
 
@@ -20,6 +20,12 @@ namespace {
 
 constexpr uint8_t HevThresh(int level) { return DivideBy16(level); }
 
+// Stored in DeblockFilterEdges::levels for the edges that the deblocking filter
+// has to compute itself (see PostFilter::StoreDeblockFilterEdges()). For the
+// chroma edges, it is only stored in the level of the U plane.
+constexpr uint8_t kDeblockFilterLevelUnknown = 0xff;
+static_assert(kDeblockFilterLevelUnknown > kMaxLoopFilterValue, "");
+
 // GetLoopFilterSize* functions depend on this exact ordering of the
 // LoopFilterSize enums.
 static_assert(dsp::kLoopFilterSize4 == 0, "");
@@ -45,15 +51,50 @@ constexpr dsp::LoopFilterSize GetLoopFilterSizeUV(int filter_length) {
   return static_cast<dsp::LoopFilterSize>(filter_length != 4);
 }
 
-bool NonBlockBorderNeedsFilter(const BlockParameters& bp, int filter_id,
+bool NonBlockBorderNeedsFilter(const BlockParametersHolder& block_parameters,
+                               ptrdiff_t offset, int filter_id,
                                uint8_t* const level) {
-  if (bp.deblock_filter_level[filter_id] == 0 || (bp.skip && bp.is_inter)) {
+  const uint8_t level_this =
+      block_parameters.deblock_filter_levels(filter_id)[offset];
+  if (level_this == 0 ||
+      (block_parameters.flags()[offset] & kBlockParametersFlagSkipInter) != 0) {
     return false;
   }
-  *level = bp.deblock_filter_level[filter_id];
+  *level = level_this;
   return true;
 }
 
+// Returns the deblock filter levels of the U and V planes for the edge between
+// the blocks at |offset| and |offset_prev| (which are in the packed planes of
+// |block_parameters|). If |is_border| is false, both offsets are in the same
+// block.
+void GetDeblockFilterLevelsUV(const BlockParametersHolder& block_parameters,
+                              ptrdiff_t offset, ptrdiff_t offset_prev,
+                              bool is_border, bool need_filter_u,
+                              bool need_filter_v, int filter_id_u,
+                              int filter_id_v, uint8_t* const level_u,
+                              uint8_t* const level_v) {
+  const uint8_t* const levels_u =
+      block_parameters.deblock_filter_levels(filter_id_u);
+  const uint8_t* const levels_v =
+      block_parameters.deblock_filter_levels(filter_id_v);
+  if (!is_border) {
+    const bool skip = (block_parameters.flags()[offset] &
+                       kBlockParametersFlagSkipInter) != 0;
+    if (need_filter_u && !skip) *level_u = levels_u[offset];
+    if (need_filter_v && !skip) *level_v = levels_v[offset];
+    return;
+  }
+  if (need_filter_u) {
+    *level_u = levels_u[offset];
+    if (*level_u == 0) *level_u = levels_u[offset_prev];
+  }
+  if (need_filter_v) {
+    *level_v = levels_v[offset];
+    if (*level_v == 0) *level_v = levels_v[offset_prev];
+  }
+}
+
 // 7.14.5.
 void ComputeDeblockFilterLevelsHelper(
     const ObuFrameHeader& frame_header, int segment_id, int level_index,
@@ -126,20 +167,23 @@ bool PostFilter::GetHorizontalDeblockFilterEdgeInfo(int row4x4, int column4x4,
   *step = kTransformHeight[inter_transform_sizes_[row4x4][column4x4]];
   if (row4x4 == 0) return false;
 
-  const BlockParameters* bp = block_parameters_.Find(row4x4, column4x4);
   const int row4x4_prev = row4x4 - 1;
   assert(row4x4_prev >= 0);
-  const BlockParameters* bp_prev =
-      block_parameters_.Find(row4x4_prev, column4x4);
+  const ptrdiff_t offset = block_parameters_.Offset(row4x4, column4x4);
+  const ptrdiff_t offset_prev = offset - block_parameters_.columns4x4();
+  BlockParameters* const* const bps = block_parameters_.Address(0, 0);
 
-  if (bp == bp_prev) {
+  if (bps[offset] == bps[offset_prev]) {
     // Not a border.
-    if (!NonBlockBorderNeedsFilter(*bp, 1, level)) return false;
+    if (!NonBlockBorderNeedsFilter(block_parameters_, offset, 1, level)) {
+      return false;
+    }
   } else {
-    const uint8_t level_this = bp->deblock_filter_level[1];
+    const uint8_t* const levels = block_parameters_.deblock_filter_levels(1);
+    const uint8_t level_this = levels[offset];
     *level = level_this;
     if (level_this == 0) {
-      const uint8_t level_prev = bp_prev->deblock_filter_level[1];
+      const uint8_t level_prev = levels[offset_prev];
       if (level_prev == 0) return false;
       *level = level_prev;
     }
@@ -157,10 +201,12 @@ void PostFilter::GetHorizontalDeblockFilterEdgeInfoUV(
   const int subsampling_y = subsampling_y_[kPlaneU];
   row4x4 = GetDeblockPosition(row4x4, subsampling_y);
   column4x4 = GetDeblockPosition(column4x4, subsampling_x);
-  const BlockParameters* bp = block_parameters_.Find(row4x4, column4x4);
+  const ptrdiff_t offset = block_parameters_.Offset(row4x4, column4x4);
+  const TransformSize* const uv_transform_sizes =
+      block_parameters_.uv_transform_sizes();
   *level_u = 0;
   *level_v = 0;
-  *step = kTransformHeight[bp->uv_transform_size];
+  *step = kTransformHeight[uv_transform_sizes[offset]];
   if (row4x4 == subsampling_y) {
     return;
   }
@@ -172,64 +218,47 @@ void PostFilter::GetHorizontalDeblockFilterEdgeInfoUV(
       kDeblockFilterLevelIndex[kPlaneU][kLoopFilterTypeHorizontal];
   const int filter_id_v =
       kDeblockFilterLevelIndex[kPlaneV][kLoopFilterTypeHorizontal];
-  const int row4x4_prev = row4x4 - (1 << subsampling_y);
-  assert(row4x4_prev >= 0);
-  const BlockParameters* bp_prev =
-      block_parameters_.Find(row4x4_prev, column4x4);
-
-  if (bp == bp_prev) {
-    // Not a border.
-    const bool skip = bp->skip && bp->is_inter;
-    need_filter_u =
-        need_filter_u && bp->deblock_filter_level[filter_id_u] != 0 && !skip;
-    need_filter_v =
-        need_filter_v && bp->deblock_filter_level[filter_id_v] != 0 && !skip;
-    if (!need_filter_u && !need_filter_v) return;
-    if (need_filter_u) *level_u = bp->deblock_filter_level[filter_id_u];
-    if (need_filter_v) *level_v = bp->deblock_filter_level[filter_id_v];
+  assert(row4x4 - (1 << subsampling_y) >= 0);
+  const ptrdiff_t offset_prev =
+      offset - (block_parameters_.columns4x4() << subsampling_y);
+  BlockParameters* const* const bps = block_parameters_.Address(0, 0);
+  const bool is_border = bps[offset] != bps[offset_prev];
+  GetDeblockFilterLevelsUV(block_parameters_, offset, offset_prev, is_border,
+                           need_filter_u, need_filter_v, filter_id_u,
+                           filter_id_v, level_u, level_v);
+  if (!is_border) {
     *filter_length = *step;
     return;
   }
-
-  // It is a border.
-  if (need_filter_u) {
-    const uint8_t level_u_this = bp->deblock_filter_level[filter_id_u];
-    *level_u = level_u_this;
-    if (level_u_this == 0) {
-      *level_u = bp_prev->deblock_filter_level[filter_id_u];
-    }
-  }
-  if (need_filter_v) {
-    const uint8_t level_v_this = bp->deblock_filter_level[filter_id_v];
-    *level_v = level_v_this;
-    if (level_v_this == 0) {
-      *level_v = bp_prev->deblock_filter_level[filter_id_v];
-    }
-  }
-  const int step_prev = kTransformHeight[bp_prev->uv_transform_size];
+  const int step_prev = kTransformHeight[uv_transform_sizes[offset_prev]];
   *filter_length = std::min(*step, step_prev);
 }
 
-bool PostFilter::GetVerticalDeblockFilterEdgeInfo(
-    int row4x4, int column4x4, BlockParameters* const* bp_ptr, uint8_t* level,
-    int* step, int* filter_length) const {
-  const BlockParameters* bp = *bp_ptr;
+bool PostFilter::GetVerticalDeblockFilterEdgeInfo(int row4x4, int column4x4,
+                                                  ptrdiff_t offset,
+                                                  uint8_t* level, int* step,
+                                                  int* filter_length) const {
   *step = kTransformWidth[inter_transform_sizes_[row4x4][column4x4]];
   if (column4x4 == 0) return false;
 
   const int filter_id = 0;
   const int column4x4_prev = column4x4 - 1;
   assert(column4x4_prev >= 0);
-  const BlockParameters* bp_prev = *(bp_ptr - 1);
-  if (bp == bp_prev) {
+  BlockParameters* const* const bps = block_parameters_.Address(0, 0);
+  if (bps[offset] == bps[offset - 1]) {
     // Not a border.
-    if (!NonBlockBorderNeedsFilter(*bp, filter_id, level)) return false;
+    if (!NonBlockBorderNeedsFilter(block_parameters_, offset, filter_id,
+                                   level)) {
+      return false;
+    }
   } else {
     // It is a border.
-    const uint8_t level_this = bp->deblock_filter_level[filter_id];
+    const uint8_t* const levels =
+        block_parameters_.deblock_filter_levels(filter_id);
+    const uint8_t level_this = levels[offset];
     *level = level_this;
     if (level_this == 0) {
-      const uint8_t level_prev = bp_prev->deblock_filter_level[filter_id];
+      const uint8_t level_prev = levels[offset - 1];
       if (level_prev == 0) return false;
       *level = level_prev;
     }
@@ -241,14 +270,15 @@ bool PostFilter::GetVerticalDeblockFilterEdgeInfo(
 }
 
 void PostFilter::GetVerticalDeblockFilterEdgeInfoUV(
-    int column4x4, BlockParameters* const* bp_ptr, uint8_t* level_u,
-    uint8_t* level_v, int* step, int* filter_length) const {
+    int column4x4, ptrdiff_t offset, uint8_t* level_u, uint8_t* level_v,
+    int* step, int* filter_length) const {
   const int subsampling_x = subsampling_x_[kPlaneU];
   column4x4 = GetDeblockPosition(column4x4, subsampling_x);
-  const BlockParameters* bp = *bp_ptr;
+  const TransformSize* const uv_transform_sizes =
+      block_parameters_.uv_transform_sizes();
   *level_u = 0;
   *level_v = 0;
-  *step = kTransformWidth[bp->uv_transform_size];
+  *step = kTransformWidth[uv_transform_sizes[offset]];
   if (column4x4 == subsampling_x) {
     return;
   }
@@ -260,97 +290,228 @@ void PostFilter::GetVerticalDeblockFilterEdgeInfoUV(
       kDeblockFilterLevelIndex[kPlaneU][kLoopFilterTypeVertical];
   const int filter_id_v =
       kDeblockFilterLevelIndex[kPlaneV][kLoopFilterTypeVertical];
-  const BlockParameters* bp_prev = *(bp_ptr - (ptrdiff_t{1} << subsampling_x));
-
-  if (bp == bp_prev) {
-    // Not a border.
-    const bool skip = bp->skip && bp->is_inter;
-    need_filter_u =
-        need_filter_u && bp->deblock_filter_level[filter_id_u] != 0 && !skip;
-    need_filter_v =
-        need_filter_v && bp->deblock_filter_level[filter_id_v] != 0 && !skip;
-    if (!need_filter_u && !need_filter_v) return;
-    if (need_filter_u) *level_u = bp->deblock_filter_level[filter_id_u];
-    if (need_filter_v) *level_v = bp->deblock_filter_level[filter_id_v];
+  const ptrdiff_t offset_prev = offset - (ptrdiff_t{1} << subsampling_x);
+  BlockParameters* const* const bps = block_parameters_.Address(0, 0);
+  const bool is_border = bps[offset] != bps[offset_prev];
+  GetDeblockFilterLevelsUV(block_parameters_, offset, offset_prev, is_border,
+                           need_filter_u, need_filter_v, filter_id_u,
+                           filter_id_v, level_u, level_v);
+  if (!is_border) {
     *filter_length = *step;
     return;
   }
+  const int step_prev = kTransformWidth[uv_transform_sizes[offset_prev]];
+  *filter_length = std::min(*step, step_prev);
+}
 
-  // It is a border.
-  if (need_filter_u) {
-    const uint8_t level_u_this = bp->deblock_filter_level[filter_id_u];
-    *level_u = level_u_this;
-    if (level_u_this == 0) {
-      *level_u = bp_prev->deblock_filter_level[filter_id_u];
+void PostFilter::StoreDeblockFilterEdges(int row4x4, int column4x4,
+                                         BlockSize block_size,
+                                         int tile_row4x4_start,
+                                         int tile_column4x4_start) {
+  if (!DoDeblock()) return;
+  const int block_row4x4_end = row4x4 + kNum4x4BlocksHigh[block_size];
+  const int block_column4x4_end = column4x4 + kNum4x4BlocksWide[block_size];
+  // Only the edges within the visible frame are filtered.
+  const int row4x4_end = std::min(block_row4x4_end, DivideBy4(height_ + 3));
+  const int column4x4_end =
+      std::min(block_column4x4_end, DivideBy4(width_ + 3));
+  if (row4x4 >= row4x4_end || column4x4 >= column4x4_end) return;
+
+  // The edges are visited in the same way as the deblocking filter used to
+  // visit them: starting from the block origin in steps of the transform size.
+  // All the other positions are not edges and get a level of 0.
+  Array2D<uint8_t>& vertical_levels =
+      deblock_filter_edges_.levels[kLoopFilterTypeVertical][kPlaneY];
+  Array2D<uint8_t>& vertical_lengths =
+      deblock_filter_edges_
+          .filter_lengths[kLoopFilterTypeVertical][kPlaneTypeY];
+  Array2D<uint8_t>& horizontal_levels =
+      deblock_filter_edges_.levels[kLoopFilterTypeHorizontal][kPlaneY];
+  Array2D<uint8_t>& horizontal_lengths =
+      deblock_filter_edges_
+          .filter_lengths[kLoopFilterTypeHorizontal][kPlaneTypeY];
+  uint8_t level;
+  int step;
+  int filter_length = 0;
+  for (int row = row4x4; row < row4x4_end; ++row) {
+    memset(&vertical_levels[row][column4x4], 0, column4x4_end - column4x4);
+    memset(&horizontal_levels[row][column4x4], 0, column4x4_end - column4x4);
+    for (int column = column4x4; column < column4x4_end;
+         column += DivideBy4(step)) {
+      if (column == tile_column4x4_start) {
+        vertical_levels[row][column] = kDeblockFilterLevelUnknown;
+        step = kTransformWidth[inter_transform_sizes_[row][column]];
+      } else if (GetVerticalDeblockFilterEdgeInfo(
+                     row, column, block_parameters_.Offset(row, column),
+                     &level, &step, &filter_length)) {
+        vertical_levels[row][column] = level;
+        vertical_lengths[row][column] = filter_length;
+      }
     }
   }
-  if (need_filter_v) {
-    const uint8_t level_v_this = bp->deblock_filter_level[filter_id_v];
-    *level_v = level_v_this;
-    if (level_v_this == 0) {
-      *level_v = bp_prev->deblock_filter_level[filter_id_v];
+  for (int column = column4x4; column < column4x4_end; ++column) {
+    for (int row = row4x4; row < row4x4_end; row += DivideBy4(step)) {
+      if (row == tile_row4x4_start) {
+        horizontal_levels[row][column] = kDeblockFilterLevelUnknown;
+        step = kTransformHeight[inter_transform_sizes_[row][column]];
+      } else if (GetHorizontalDeblockFilterEdgeInfo(row, column, &level, &step,
+                                                    &filter_length)) {
+        horizontal_levels[row][column] = level;
+        horizontal_lengths[row][column] = filter_length;
+      }
+    }
+  }
+
+  if (!needs_chroma_deblock_) return;
+  // The chroma edges are stored at the (even, if subsampled) luma positions
+  // that the deblocking filter visits. The block parameters of such a position
+  // are those of the block at GetDeblockPosition(), so this block owns the
+  // positions whose deblock position is inside it.
+  const int8_t subsampling_x = subsampling_x_[kPlaneU];
+  const int8_t subsampling_y = subsampling_y_[kPlaneU];
+  const int uv_row4x4 = row4x4 & ~subsampling_y;
+  const int uv_column4x4 = column4x4 & ~subsampling_x;
+  if (GetDeblockPosition(uv_row4x4, subsampling_y) >= block_row4x4_end ||
+      GetDeblockPosition(uv_column4x4, subsampling_x) >= block_column4x4_end) {
+    return;
+  }
+  const TransformSize* const uv_transform_sizes =
+      block_parameters_.uv_transform_sizes();
+  uint8_t level_v;
+  for (int type = kLoopFilterTypeVertical; type < kNumLoopFilterTypes;
+       ++type) {
+    Array2D<uint8_t>* const levels = deblock_filter_edges_.levels[type];
+    for (int row = uv_row4x4; row < row4x4_end; row += 1 << subsampling_y) {
+      memset(&levels[kPlaneU][row][uv_column4x4], 0,
+             column4x4_end - uv_column4x4);
+      memset(&levels[kPlaneV][row][uv_column4x4], 0,
+             column4x4_end - uv_column4x4);
+    }
+  }
+  Array2D<uint8_t>& vertical_levels_u =
+      deblock_filter_edges_.levels[kLoopFilterTypeVertical][kPlaneU];
+  Array2D<uint8_t>& vertical_levels_v =
+      deblock_filter_edges_.levels[kLoopFilterTypeVertical][kPlaneV];
+  Array2D<uint8_t>& vertical_lengths_uv =
+      deblock_filter_edges_
+          .filter_lengths[kLoopFilterTypeVertical][kPlaneTypeUV];
+  for (int row = uv_row4x4; row < row4x4_end; row += 1 << subsampling_y) {
+    for (int column = uv_column4x4; column < column4x4_end;
+         column += DivideBy4(step << subsampling_x)) {
+      const ptrdiff_t offset =
+          block_parameters_.Offset(GetDeblockPosition(row, subsampling_y),
+                                   GetDeblockPosition(column, subsampling_x));
+      if (column == tile_column4x4_start) {
+        vertical_levels_u[row][column] = kDeblockFilterLevelUnknown;
+        step = kTransformWidth[uv_transform_sizes[offset]];
+        continue;
+      }
+      GetVerticalDeblockFilterEdgeInfoUV(column, offset, &level, &level_v,
+                                         &step, &filter_length);
+      vertical_levels_u[row][column] = level;
+      vertical_levels_v[row][column] = level_v;
+      vertical_lengths_uv[row][column] = filter_length;
+    }
+  }
+  Array2D<uint8_t>& horizontal_levels_u =
+      deblock_filter_edges_.levels[kLoopFilterTypeHorizontal][kPlaneU];
+  Array2D<uint8_t>& horizontal_levels_v =
+      deblock_filter_edges_.levels[kLoopFilterTypeHorizontal][kPlaneV];
+  Array2D<uint8_t>& horizontal_lengths_uv =
+      deblock_filter_edges_
+          .filter_lengths[kLoopFilterTypeHorizontal][kPlaneTypeUV];
+  for (int column = uv_column4x4; column < column4x4_end;
+       column += 1 << subsampling_x) {
+    for (int row = uv_row4x4; row < row4x4_end;
+         row += DivideBy4(step << subsampling_y)) {
+      if (row == tile_row4x4_start) {
+        const ptrdiff_t offset = block_parameters_.Offset(
+            GetDeblockPosition(row, subsampling_y),
+            GetDeblockPosition(column, subsampling_x));
+        horizontal_levels_u[row][column] = kDeblockFilterLevelUnknown;
+        step = kTransformHeight[uv_transform_sizes[offset]];
+        continue;
+      }
+      GetHorizontalDeblockFilterEdgeInfoUV(row, column, &level, &level_v, &step,
+                                           &filter_length);
+      horizontal_levels_u[row][column] = level;
+      horizontal_levels_v[row][column] = level_v;
+      horizontal_lengths_uv[row][column] = filter_length;
     }
   }
-  const int step_prev = kTransformWidth[bp_prev->uv_transform_size];
-  *filter_length = std::min(*step, step_prev);
 }
 
 void PostFilter::HorizontalDeblockFilter(int row4x4_start,
                                          int column4x4_start) {
-  const int column_step = 1;
   const int src_step = 4 << pixel_size_log2_;
   const ptrdiff_t src_stride = frame_buffer_.stride(kPlaneY);
+  const ptrdiff_t row_stride = MultiplyBy4(src_stride);
   uint8_t* src = GetSourceBuffer(kPlaneY, row4x4_start, column4x4_start);
-  int row_step;
-  uint8_t level;
-  int filter_length;
-
-  for (int column4x4 = 0; column4x4 < kNum4x4InLoopFilterUnit &&
-                          MultiplyBy4(column4x4_start + column4x4) < width_;
-       column4x4 += column_step, src += src_step) {
+  const Array2D<uint8_t>& levels =
+      deblock_filter_edges_.levels[kLoopFilterTypeHorizontal][kPlaneY];
+  const Array2D<uint8_t>& filter_lengths =
+      deblock_filter_edges_
+          .filter_lengths[kLoopFilterTypeHorizontal][kPlaneTypeY];
+  int step;
+
+  for (int column4x4 = column4x4_start;
+       column4x4 < column4x4_start + kNum4x4InLoopFilterUnit &&
+       MultiplyBy4(column4x4) < width_;
+       ++column4x4, src += src_step) {
     uint8_t* src_row = src;
-    for (int row4x4 = 0; row4x4 < kNum4x4InLoopFilterUnit &&
-                         MultiplyBy4(row4x4_start + row4x4) < height_;
-         row4x4 += row_step) {
-      const bool need_filter = GetHorizontalDeblockFilterEdgeInfo(
-          row4x4_start + row4x4, column4x4_start + column4x4, &level, &row_step,
-          &filter_length);
-      if (need_filter) {
-        const dsp::LoopFilterSize size = GetLoopFilterSizeY(filter_length);
-        dsp_.loop_filters[size][kLoopFilterTypeHorizontal](
-            src_row, src_stride, outer_thresh_[level], inner_thresh_[level],
-            HevThresh(level));
+    for (int row4x4 = row4x4_start;
+         row4x4 < row4x4_start + kNum4x4InLoopFilterUnit &&
+         MultiplyBy4(row4x4) < height_;
+         ++row4x4, src_row += row_stride) {
+      uint8_t level = levels[row4x4][column4x4];
+      int filter_length = filter_lengths[row4x4][column4x4];
+      if (level == kDeblockFilterLevelUnknown &&
+          !GetHorizontalDeblockFilterEdgeInfo(row4x4, column4x4, &level, &step,
+                                              &filter_length)) {
+        continue;
       }
-      // TODO(chengchen): use shifts instead of multiplication.
-      src_row += row_step * src_stride;
-      row_step = DivideBy4(row_step);
+      if (level == 0) continue;
+      const dsp::LoopFilterSize size = GetLoopFilterSizeY(filter_length);
+      dsp_.loop_filters[size][kLoopFilterTypeHorizontal](
+          src_row, src_stride, outer_thresh_[level], inner_thresh_[level],
+          HevThresh(level));
     }
   }
 
   if (needs_chroma_deblock_) {
     const int8_t subsampling_x = subsampling_x_[kPlaneU];
     const int8_t subsampling_y = subsampling_y_[kPlaneU];
-    const int column_step = 1 << subsampling_x;
     const ptrdiff_t src_stride_u = frame_buffer_.stride(kPlaneU);
     const ptrdiff_t src_stride_v = frame_buffer_.stride(kPlaneV);
+    const ptrdiff_t row_stride_u = MultiplyBy4(src_stride_u);
+    const ptrdiff_t row_stride_v = MultiplyBy4(src_stride_v);
     uint8_t* src_u = GetSourceBuffer(kPlaneU, row4x4_start, column4x4_start);
     uint8_t* src_v = GetSourceBuffer(kPlaneV, row4x4_start, column4x4_start);
-    int row_step;
-    uint8_t level_u;
-    uint8_t level_v;
-    int filter_length;
-
-    for (int column4x4 = 0; column4x4 < kNum4x4InLoopFilterUnit &&
-                            MultiplyBy4(column4x4_start + column4x4) < width_;
-         column4x4 += column_step, src_u += src_step, src_v += src_step) {
+    const Array2D<uint8_t>* const levels_uv =
+        deblock_filter_edges_.levels[kLoopFilterTypeHorizontal];
+    const Array2D<uint8_t>& filter_lengths_uv =
+        deblock_filter_edges_
+            .filter_lengths[kLoopFilterTypeHorizontal][kPlaneTypeUV];
+
+    for (int column4x4 = column4x4_start;
+         column4x4 < column4x4_start + kNum4x4InLoopFilterUnit &&
+         MultiplyBy4(column4x4) < width_;
+         column4x4 += 1 << subsampling_x, src_u += src_step,
+             src_v += src_step) {
       uint8_t* src_row_u = src_u;
       uint8_t* src_row_v = src_v;
-      for (int row4x4 = 0; row4x4 < kNum4x4InLoopFilterUnit &&
-                           MultiplyBy4(row4x4_start + row4x4) < height_;
-           row4x4 += row_step) {
-        GetHorizontalDeblockFilterEdgeInfoUV(
-            row4x4_start + row4x4, column4x4_start + column4x4, &level_u,
-            &level_v, &row_step, &filter_length);
+      for (int row4x4 = row4x4_start;
+           row4x4 < row4x4_start + kNum4x4InLoopFilterUnit &&
+           MultiplyBy4(row4x4) < height_;
+           row4x4 += 1 << subsampling_y, src_row_u += row_stride_u,
+               src_row_v += row_stride_v) {
+        uint8_t level_u = levels_uv[kPlaneU][row4x4][column4x4];
+        uint8_t level_v = levels_uv[kPlaneV][row4x4][column4x4];
+        int filter_length = filter_lengths_uv[row4x4][column4x4];
+        if (level_u == kDeblockFilterLevelUnknown) {
+          GetHorizontalDeblockFilterEdgeInfoUV(row4x4, column4x4, &level_u,
+                                               &level_v, &step, &filter_length);
+        }
         if (level_u != 0) {
           const dsp::LoopFilterSize size = GetLoopFilterSizeUV(filter_length);
           dsp_.loop_filters[size][kLoopFilterTypeHorizontal](
@@ -363,52 +524,53 @@ void PostFilter::HorizontalDeblockFilter(int row4x4_start,
               src_row_v, src_stride_v, outer_thresh_[level_v],
               inner_thresh_[level_v], HevThresh(level_v));
         }
-        src_row_u += row_step * src_stride_u;
-        src_row_v += row_step * src_stride_v;
-        row_step = DivideBy4(row_step << subsampling_y);
       }
     }
   }
 }
 
 void PostFilter::VerticalDeblockFilter(int row4x4_start, int column4x4_start) {
-  const ptrdiff_t row_stride = MultiplyBy4(frame_buffer_.stride(kPlaneY));
   const ptrdiff_t src_stride = frame_buffer_.stride(kPlaneY);
+  const ptrdiff_t row_stride = MultiplyBy4(src_stride);
+  const int src_step = 4 << pixel_size_log2_;
   uint8_t* src = GetSourceBuffer(kPlaneY, row4x4_start, column4x4_start);
-  int column_step;
-  uint8_t level;
-  int filter_length;
-
-  BlockParameters* const* bp_row_base =
-      block_parameters_.Address(row4x4_start, column4x4_start);
-  const int bp_stride = block_parameters_.columns4x4();
-  const int column_step_shift = pixel_size_log2_;
-  for (int row4x4 = 0; row4x4 < kNum4x4InLoopFilterUnit &&
-                       MultiplyBy4(row4x4_start + row4x4) < height_;
-       ++row4x4, src += row_stride, bp_row_base += bp_stride) {
+  const Array2D<uint8_t>& levels =
+      deblock_filter_edges_.levels[kLoopFilterTypeVertical][kPlaneY];
+  const Array2D<uint8_t>& filter_lengths =
+      deblock_filter_edges_
+          .filter_lengths[kLoopFilterTypeVertical][kPlaneTypeY];
+  int step;
+
+  for (int row4x4 = row4x4_start;
+       row4x4 < row4x4_start + kNum4x4InLoopFilterUnit &&
+       MultiplyBy4(row4x4) < height_;
+       ++row4x4, src += row_stride) {
     uint8_t* src_row = src;
-    BlockParameters* const* bp = bp_row_base;
-    for (int column4x4 = 0; column4x4 < kNum4x4InLoopFilterUnit &&
-                            MultiplyBy4(column4x4_start + column4x4) < width_;
-         column4x4 += column_step, bp += column_step) {
-      const bool need_filter = GetVerticalDeblockFilterEdgeInfo(
-          row4x4_start + row4x4, column4x4_start + column4x4, bp, &level,
-          &column_step, &filter_length);
-      if (need_filter) {
-        const dsp::LoopFilterSize size = GetLoopFilterSizeY(filter_length);
-        dsp_.loop_filters[size][kLoopFilterTypeVertical](
-            src_row, src_stride, outer_thresh_[level], inner_thresh_[level],
-            HevThresh(level));
+    const uint8_t* const row_levels = levels[row4x4];
+    const uint8_t* const row_filter_lengths = filter_lengths[row4x4];
+    for (int column4x4 = column4x4_start;
+         column4x4 < column4x4_start + kNum4x4InLoopFilterUnit &&
+         MultiplyBy4(column4x4) < width_;
+         ++column4x4, src_row += src_step) {
+      uint8_t level = row_levels[column4x4];
+      int filter_length = row_filter_lengths[column4x4];
+      if (level == kDeblockFilterLevelUnknown &&
+          !GetVerticalDeblockFilterEdgeInfo(
+              row4x4, column4x4, block_parameters_.Offset(row4x4, column4x4),
+              &level, &step, &filter_length)) {
+        continue;
       }
-      src_row += column_step << column_step_shift;
-      column_step = DivideBy4(column_step);
+      if (level == 0) continue;
+      const dsp::LoopFilterSize size = GetLoopFilterSizeY(filter_length);
+      dsp_.loop_filters[size][kLoopFilterTypeVertical](
+          src_row, src_stride, outer_thresh_[level], inner_thresh_[level],
+          HevThresh(level));
     }
   }
 
   if (needs_chroma_deblock_) {
     const int8_t subsampling_x = subsampling_x_[kPlaneU];
     const int8_t subsampling_y = subsampling_y_[kPlaneU];
-    const int row_step = 1 << subsampling_y;
     uint8_t* src_u = GetSourceBuffer(kPlaneU, row4x4_start, column4x4_start);
     uint8_t* src_v = GetSourceBuffer(kPlaneV, row4x4_start, column4x4_start);
     const ptrdiff_t src_stride_u = frame_buffer_.stride(kPlaneU);
@@ -416,28 +578,34 @@ void PostFilter::VerticalDeblockFilter(int row4x4_start, int column4x4_start) {
     const ptrdiff_t row_stride_u = MultiplyBy4(frame_buffer_.stride(kPlaneU));
     const ptrdiff_t row_stride_v = MultiplyBy4(frame_buffer_.stride(kPlaneV));
     const LoopFilterType type = kLoopFilterTypeVertical;
-    int column_step;
-    uint8_t level_u;
-    uint8_t level_v;
-    int filter_length;
-
-    BlockParameters* const* bp_row_base = block_parameters_.Address(
-        GetDeblockPosition(row4x4_start, subsampling_y),
-        GetDeblockPosition(column4x4_start, subsampling_x));
-    const int bp_stride = block_parameters_.columns4x4() << subsampling_y;
-    for (int row4x4 = 0; row4x4 < kNum4x4InLoopFilterUnit &&
-                         MultiplyBy4(row4x4_start + row4x4) < height_;
-         row4x4 += row_step, src_u += row_stride_u, src_v += row_stride_v,
-             bp_row_base += bp_stride) {
+    const Array2D<uint8_t>* const levels_uv =
+        deblock_filter_edges_.levels[type];
+    const Array2D<uint8_t>& filter_lengths_uv =
+        deblock_filter_edges_.filter_lengths[type][kPlaneTypeUV];
+
+    for (int row4x4 = row4x4_start;
+         row4x4 < row4x4_start + kNum4x4InLoopFilterUnit &&
+         MultiplyBy4(row4x4) < height_;
+         row4x4 += 1 << subsampling_y, src_u += row_stride_u,
+             src_v += row_stride_v) {
       uint8_t* src_row_u = src_u;
       uint8_t* src_row_v = src_v;
-      BlockParameters* const* bp = bp_row_base;
-      for (int column4x4 = 0; column4x4 < kNum4x4InLoopFilterUnit &&
-                              MultiplyBy4(column4x4_start + column4x4) < width_;
-           column4x4 += column_step, bp += column_step) {
-        GetVerticalDeblockFilterEdgeInfoUV(column4x4_start + column4x4, bp,
-                                           &level_u, &level_v, &column_step,
-                                           &filter_length);
+      for (int column4x4 = column4x4_start;
+           column4x4 < column4x4_start + kNum4x4InLoopFilterUnit &&
+           MultiplyBy4(column4x4) < width_;
+           column4x4 += 1 << subsampling_x, src_row_u += src_step,
+               src_row_v += src_step) {
+        uint8_t level_u = levels_uv[kPlaneU][row4x4][column4x4];
+        uint8_t level_v = levels_uv[kPlaneV][row4x4][column4x4];
+        int filter_length = filter_lengths_uv[row4x4][column4x4];
+        if (level_u == kDeblockFilterLevelUnknown) {
+          GetVerticalDeblockFilterEdgeInfoUV(
+              column4x4,
+              block_parameters_.Offset(
+                  GetDeblockPosition(row4x4, subsampling_y),
+                  GetDeblockPosition(column4x4, subsampling_x)),
+              &level_u, &level_v, &step, &filter_length);
+        }
         if (level_u != 0) {
           const dsp::LoopFilterSize size = GetLoopFilterSizeUV(filter_length);
           dsp_.loop_filters[size][type](
@@ -450,9 +618,6 @@ void PostFilter::VerticalDeblockFilter(int row4x4_start, int column4x4_start) {
               src_row_v, src_stride_v, outer_thresh_[level_v],
               inner_thresh_[level_v], HevThresh(level_v));
         }
-        src_row_u += column_step << column_step_shift;
-        src_row_v += column_step << column_step_shift;
-        column_step = DivideBy4(column_step << subsampling_x);
       }
     }
   }
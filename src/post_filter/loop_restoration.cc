@@ -15,19 +15,43 @@
 #include "src/utils/blocking_counter.h"
 
 namespace libgav1 {
+namespace {
+
+// Returns true if the restoration units |a| and |b| apply the same filter.
+bool HasSameFilter(const RestorationUnitInfo& a, const RestorationUnitInfo& b) {
+  if (a.type != b.type) return false;
+  if (a.type == kLoopRestorationTypeSgrProj) {
+    return a.sgr_proj_info.index == b.sgr_proj_info.index &&
+           a.sgr_proj_info.multiplier[0] == b.sgr_proj_info.multiplier[0] &&
+           a.sgr_proj_info.multiplier[1] == b.sgr_proj_info.multiplier[1];
+  }
+  assert(a.type == kLoopRestorationTypeWiener);
+  for (int i = 0; i < 2; ++i) {
+    if (a.wiener_info.number_leading_zero_coefficients[i] !=
+            b.wiener_info.number_leading_zero_coefficients[i] ||
+        memcmp(a.wiener_info.filter[i], b.wiener_info.filter[i],
+               sizeof(a.wiener_info.filter[i])) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
 
 template <typename Pixel>
 void PostFilter::ApplyLoopRestorationForOneRow(
     const Pixel* src_buffer, const ptrdiff_t stride, const Plane plane,
     const int plane_height, const int plane_width, const int unit_y,
     const int unit_row, const int current_process_unit_height,
-    const int plane_unit_size, Pixel* dst_buffer) {
+    const int plane_unit_size, Pixel* dst_buffer, Pixel* const unit_buffer) {
   const int num_horizontal_units =
       restoration_info_->num_horizontal_units(static_cast<Plane>(plane));
   const RestorationUnitInfo* const restoration_info =
       restoration_info_->loop_restoration_info(static_cast<Plane>(plane),
                                                unit_row * num_horizontal_units);
   const bool in_place = DoCdef() || thread_pool_ != nullptr;
+  assert(in_place == (unit_buffer != nullptr));
   const Pixel* border = nullptr;
   src_buffer += unit_y * stride;
   if (in_place) {
@@ -39,25 +63,46 @@ void PostFilter::ApplyLoopRestorationForOneRow(
         reinterpret_cast<const Pixel*>(loop_restoration_border_.data(plane)) +
         border_unit_y * stride;
   }
+  // In the |in_place| case, the filtered units are written into |unit_buffer|
+  // and copied to |dst_buffer| (which is the same as the source) once the next
+  // unit has been filtered, since the next unit reads the last few source
+  // columns of the current one.
+  int pending_column = 0;
+  int pending_width = 0;
   int unit_column = 0;
   int column = 0;
   do {
-    const int current_process_unit_width =
+    int current_process_unit_width =
         std::min(plane_unit_size, plane_width - column);
     const Pixel* src = src_buffer + column;
     unit_column = std::min(unit_column, num_horizontal_units - 1);
-    if (restoration_info[unit_column].type == kLoopRestorationTypeNone) {
-      Pixel* dst = dst_buffer + column;
-      if (in_place) {
-        int k = current_process_unit_height;
-        do {
-          memmove(dst, src, current_process_unit_width * sizeof(Pixel));
-          src += stride;
-          dst += stride;
-        } while (--k != 0);
-      } else {
+    const LoopRestorationType type = restoration_info[unit_column].type;
+    // Adjacent units that apply the same filter are processed with a single
+    // call so that the columns around their shared edges are filtered only
+    // once and the row buffers of the filter carry over across the edge. The
+    // result is the same since the filters read the pixels across the unit
+    // edges anyway. The width of one call is limited by the size of the
+    // RestorationBuffer.
+    while (type != kLoopRestorationTypeNone &&
+           column + current_process_unit_width < plane_width) {
+      const int next_unit_column =
+          std::min(unit_column + 1, num_horizontal_units - 1);
+      const int next_width =
+          std::min(plane_unit_size,
+                   plane_width - column - current_process_unit_width);
+      if (current_process_unit_width + next_width > kRestorationUnitWidth ||
+          !HasSameFilter(restoration_info[unit_column],
+                         restoration_info[next_unit_column])) {
+        break;
+      }
+      current_process_unit_width += next_width;
+      unit_column = next_unit_column;
+    }
+    if (type == kLoopRestorationTypeNone) {
+      // In the |in_place| case, the pixels are already where they belong.
+      if (!in_place) {
         CopyPlane(src, stride, current_process_unit_width,
-                  current_process_unit_height, dst, stride);
+                  current_process_unit_height, dst_buffer + column, stride);
       }
     } else {
       const Pixel* top_border = src - kRestorationVerticalBorder * stride;
@@ -76,24 +121,37 @@ void PostFilter::ApplyLoopRestorationForOneRow(
         }
       }
       RestorationBuffer restoration_buffer;
-      const LoopRestorationType type = restoration_info[unit_column].type;
       assert(type == kLoopRestorationTypeSgrProj ||
              type == kLoopRestorationTypeWiener);
       const dsp::LoopRestorationFunc restoration_func =
           dsp_.loop_restorations[type - 2];
-      restoration_func(restoration_info[unit_column], src, top_border,
-                       bottom_border, stride, current_process_unit_width,
-                       current_process_unit_height, &restoration_buffer,
-                       dst_buffer + column);
+      restoration_func(
+          restoration_info[unit_column], src, top_border, bottom_border, stride,
+          current_process_unit_width, current_process_unit_height,
+          &restoration_buffer, (in_place ? unit_buffer : dst_buffer) + column);
+    }
+    if (pending_width != 0) {
+      CopyPlane(unit_buffer + pending_column, stride, pending_width,
+                current_process_unit_height, dst_buffer + pending_column,
+                stride);
+      pending_width = 0;
+    }
+    if (in_place && type != kLoopRestorationTypeNone) {
+      pending_column = column;
+      pending_width = current_process_unit_width;
     }
     ++unit_column;
-    column += plane_unit_size;
+    column += current_process_unit_width;
   } while (column < plane_width);
+  if (pending_width != 0) {
+    CopyPlane(unit_buffer + pending_column, stride, pending_width,
+              current_process_unit_height, dst_buffer + pending_column, stride);
+  }
 }
 
 template <typename Pixel>
-void PostFilter::ApplyLoopRestorationForOneSuperBlockRow(const int row4x4_start,
-                                                         const int sb4x4) {
+void PostFilter::ApplyLoopRestorationForOneSuperBlockRow(
+    const int row4x4_start, const int sb4x4, const int unit_buffer_index) {
   assert(row4x4_start >= 0);
   assert(DoRestoration());
   int plane = kPlaneY;
@@ -102,6 +160,14 @@ void PostFilter::ApplyLoopRestorationForOneSuperBlockRow(const int row4x4_start,
       continue;
     }
     const ptrdiff_t stride = frame_buffer_.stride(plane) / sizeof(Pixel);
+    Pixel* unit_buffer = nullptr;
+    if (DoCdef() || thread_pool_ != nullptr) {
+      assert(loop_restoration_unit_buffer_.stride(plane) ==
+             frame_buffer_.stride(plane));
+      unit_buffer =
+          reinterpret_cast<Pixel*>(loop_restoration_unit_buffer_.data(plane)) +
+          unit_buffer_index * kRestorationUnitHeight * stride;
+    }
     const int unit_height_offset =
         kRestorationUnitOffset >> subsampling_y_[plane];
     const int plane_height = SubsampledValue(height_, subsampling_y_[plane]);
@@ -130,7 +196,8 @@ void PostFilter::ApplyLoopRestorationForOneSuperBlockRow(const int row4x4_start,
           static_cast<Plane>(plane), plane_height, plane_width, y, unit_row,
           current_process_unit_height, plane_unit_size,
           reinterpret_cast<Pixel*>(loop_restoration_buffer_[plane]) +
-              y * stride);
+              y * stride,
+          unit_buffer);
     }
   } while (++plane < planes_);
 }
@@ -138,14 +205,18 @@ void PostFilter::ApplyLoopRestorationForOneSuperBlockRow(const int row4x4_start,
 void PostFilter::ApplyLoopRestoration(const int row4x4_start, const int sb4x4) {
 #if LIBGAV1_MAX_BITDEPTH >= 10
   if (bitdepth_ >= 10) {
-    ApplyLoopRestorationForOneSuperBlockRow<uint16_t>(row4x4_start, sb4x4);
+    ApplyLoopRestorationForOneSuperBlockRow<uint16_t>(row4x4_start, sb4x4,
+                                                      /*unit_buffer_index=*/0);
     return;
   }
 #endif
-  ApplyLoopRestorationForOneSuperBlockRow<uint8_t>(row4x4_start, sb4x4);
+  ApplyLoopRestorationForOneSuperBlockRow<uint8_t>(row4x4_start, sb4x4,
+                                                   /*unit_buffer_index=*/0);
 }
 
 void PostFilter::ApplyLoopRestorationWorker(std::atomic<int>* row4x4_atomic) {
+  const int unit_buffer_index =
+      loop_restoration_workers_.fetch_add(1, std::memory_order_relaxed);
   int row4x4;
   // Loop Restoration operates with a lag of 8 rows (4 for chroma with
   // subsampling) and hence we need to make sure to cover the last 8 rows of the
@@ -160,12 +231,12 @@ void PostFilter::ApplyLoopRestorationWorker(std::atomic<int>* row4x4_atomic) {
 #if LIBGAV1_MAX_BITDEPTH >= 10
     if (bitdepth_ >= 10) {
       ApplyLoopRestorationForOneSuperBlockRow<uint16_t>(
-          row4x4, kNum4x4InLoopRestorationUnit);
+          row4x4, kNum4x4InLoopRestorationUnit, unit_buffer_index);
       continue;
     }
 #endif
     ApplyLoopRestorationForOneSuperBlockRow<uint8_t>(
-        row4x4, kNum4x4InLoopRestorationUnit);
+        row4x4, kNum4x4InLoopRestorationUnit, unit_buffer_index);
   }
 }
 
@@ -167,6 +167,7 @@ PostFilter::PostFilter(const ObuFrameHeader& frame_header,
                             frame_header.loop_filter.level[kPlaneV + 1] != 0),
       cdef_index_(frame_scratch_buffer->cdef_index),
       inter_transform_sizes_(frame_scratch_buffer->inter_transform_sizes),
+      deblock_filter_edges_(frame_scratch_buffer->deblock_filter_edges),
       restoration_info_(&frame_scratch_buffer->loop_restoration_info),
       superres_coefficients_{
           frame_scratch_buffer->superres_coefficients[kPlaneTypeY].get(),
@@ -182,6 +183,8 @@ PostFilter::PostFilter(const ObuFrameHeader& frame_header,
       frame_buffer_(*frame_buffer),
       cdef_border_(frame_scratch_buffer->cdef_border),
       loop_restoration_border_(frame_scratch_buffer->loop_restoration_border),
+      loop_restoration_unit_buffer_(
+          frame_scratch_buffer->loop_restoration_unit_buffer),
       do_post_filter_mask_(do_post_filter_mask),
       thread_pool_(
           frame_scratch_buffer->threading_strategy.post_filter_thread_pool()) {
@@ -234,12 +237,14 @@ PostFilter::PostFilter(const ObuFrameHeader& frame_header,
     do {
       int horizontal_shift = 0;
       int vertical_shift = 0;
+      // When |loop_restoration_border_| is used (cdef is on or multi-threading
+      // is enabled), loop restoration is done in place with the help of
+      // |loop_restoration_unit_buffer_|, so no shift is needed.
       if (DoRestoration() &&
-          loop_restoration_.type[plane] != kLoopRestorationTypeNone) {
+          loop_restoration_.type[plane] != kLoopRestorationTypeNone &&
+          !DoCdef() && thread_pool_ == nullptr) {
         horizontal_shift += frame_buffer_.alignment();
-        if (!DoCdef() && thread_pool_ == nullptr) {
-          vertical_shift += kRestorationVerticalBorder;
-        }
+        vertical_shift += kRestorationVerticalBorder;
         superres_buffer_[plane] +=
             vertical_shift * frame_buffer_.stride(plane) +
             (horizontal_shift << pixel_size_log2);
@@ -22,6 +22,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <mutex>  // NOLINT (unapproved c++11 header)
+#include <new>
 
 #include "src/utils/array_2d.h"
 #include "src/utils/bit_mask_set.h"
@@ -233,4 +235,18 @@ bool GenerateWedgeMask(WedgeMaskArray* const wedge_masks) {
   return true;
 }
 
+const WedgeMaskArray* GetWedgeMasks() {
+  // The masks are intentionally leaked so that they remain valid for decoders
+  // that are still alive while static objects are destroyed.
+  static std::mutex mutex;
+  static WedgeMaskArray* wedge_masks = nullptr;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (wedge_masks == nullptr) {
+    std::unique_ptr<WedgeMaskArray> masks(new (std::nothrow) WedgeMaskArray);
+    if (masks == nullptr || !GenerateWedgeMask(masks.get())) return nullptr;
+    wedge_masks = masks.release();
+  }
+  return wedge_masks;
+}
+
 }  // namespace libgav1
@@ -31,11 +31,16 @@ constexpr BitMaskSet kIsWedgeCompoundModeAllowed(kBlock8x8, kBlock8x16,
                                                  kBlock32x8, kBlock32x16,
                                                  kBlock32x32);
 
-// This function generates wedge masks. It should be called only once for the
-// decoder. If the video is key frame only, we don't have to call this
-// function. Returns true on success, false on allocation failure.
+// This function generates wedge masks. Decoders should use GetWedgeMasks()
+// instead of calling this directly. Returns true on success, false on
+// allocation failure.
 // 7.11.3.11.
 bool GenerateWedgeMask(WedgeMaskArray* wedge_masks);
 
+// Returns the wedge masks shared by all the decoder instances in the process.
+// The masks are generated by the first successful call and are never freed.
+// Returns nullptr on allocation failure. This function is thread safe.
+const WedgeMaskArray* GetWedgeMasks();
+
 }  // namespace libgav1
 #endif  // LIBGAV1_SRC_PREDICTION_MASK_H_
@@ -16,6 +16,9 @@
 
 #include <cassert>
 #include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT (unapproved c++11 header)
+#include <new>
 
 #include "src/utils/common.h"
 #include "src/utils/constants.h"
@@ -238,6 +241,23 @@ bool InitializeQuantizerMatrix(QuantizerMatrix* quantizer_matrix_ptr) {
   return true;
 }
 
+const QuantizerMatrix* GetQuantizerMatrix() {
+  // The matrix is intentionally leaked so that it remains valid for decoders
+  // that are still alive while static objects are destroyed.
+  static std::mutex mutex;
+  static QuantizerMatrix* quantizer_matrix = nullptr;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (quantizer_matrix == nullptr) {
+    std::unique_ptr<QuantizerMatrix> matrix(new (std::nothrow)
+                                                QuantizerMatrix);
+    if (matrix == nullptr || !InitializeQuantizerMatrix(matrix.get())) {
+      return nullptr;
+    }
+    quantizer_matrix = matrix.release();
+  }
+  return quantizer_matrix;
+}
+
 int GetQIndex(const Segmentation& segmentation, int index, int base_qindex) {
   if (segmentation.FeatureActive(index, kSegmentFeatureQuantizer)) {
     const int segment_qindex =
@@ -57,6 +57,11 @@ class Quantizer {
 // Initialize the quantizer matrix.
 bool InitializeQuantizerMatrix(QuantizerMatrix* quantizer_matrix);
 
+// Returns the quantizer matrix shared by all the decoder instances in the
+// process. The matrix is initialized by the first successful call and is never
+// freed. Returns nullptr on allocation failure. This function is thread safe.
+const QuantizerMatrix* GetQuantizerMatrix();
+
 // Get the quantizer index for the |index|th segment.
 //
 // This function has two use cases. What should be passed as the |base_qindex|
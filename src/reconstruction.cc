@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 
 #include "src/utils/common.h"
 
@@ -127,6 +128,26 @@ int GetNumRows(TransformType tx_type, int tx_height, int non_zero_coeff_count) {
   return (tx_width >= 16) ? std::min(tx_height, 32) : tx_height;
 }
 
+// Returns the smallest dsp::TransformSubRegion that contains all the non-zero
+// coefficients of a kTransformTypeDctDct block, or
+// dsp::kNumTransformSubRegions if none applies. The sub-regions are only used
+// when both transform dimensions are at least twice the sub-region size. The
+// thresholds are the largest |non_zero_coeff_count| (eob) values whose default
+// scan positions all fall within the sub-region.
+dsp::TransformSubRegion GetDctSubRegion(TransformSize tx_size,
+                                        int non_zero_coeff_count) {
+  if (non_zero_coeff_count == 1) return dsp::kTransformSubRegionDcOnly;
+  const int min_size_log2 = std::min(kTransformWidthLog2[tx_size],
+                                     kTransformHeightLog2[tx_size]);
+  if (min_size_log2 >= 4 && non_zero_coeff_count <= 36) {
+    return dsp::kTransformSubRegion8x8;
+  }
+  if (min_size_log2 >= 5 && non_zero_coeff_count <= 136) {
+    return dsp::kTransformSubRegion16x16;
+  }
+  return dsp::kNumTransformSubRegions;
+}
+
 }  // namespace
 
 template <typename Residual, typename Pixel>
@@ -138,6 +159,20 @@ void Reconstruct(const dsp::Dsp& dsp, TransformType tx_type,
   const int tx_width_log2 = kTransformWidthLog2[tx_size];
   const int tx_height_log2 = kTransformHeightLog2[tx_size];
 
+  if (!lossless && tx_type == kTransformTypeDctDct) {
+    const dsp::TransformSubRegion sub_region =
+        GetDctSubRegion(tx_size, non_zero_coeff_count);
+    if (sub_region != dsp::kNumTransformSubRegions) {
+      const dsp::InverseTransformDctAddFunc sub_region_func =
+          dsp.inverse_transforms_dct_sub_region[sub_region][Get1DTransformSize(
+              tx_height_log2)];
+      if (sub_region_func != nullptr) {
+        sub_region_func(tx_size, buffer, start_x, start_y, frame);
+        return;
+      }
+    }
+  }
+
   int tx_height = (non_zero_coeff_count == 1) ? 1 : kTransformHeight[tx_size];
   if (tx_height > 4) {
     static constexpr int (*kGetNumRows[])(TransformType tx_type, int tx_height,
@@ -175,6 +210,48 @@ void Reconstruct(const dsp::Dsp& dsp, TransformType tx_type,
                         frame);
 }
 
+template <typename Residual>
+int KeepLowFrequencyCoefficients(TransformType tx_type, TransformSize tx_size,
+                                 int scale_log2, Residual* const buffer,
+                                 int non_zero_coeff_count) {
+  assert(scale_log2 > 0);
+  if (non_zero_coeff_count == 1) return 1;
+  const int tx_width = kTransformWidth[tx_size];
+  const int tx_height = kTransformHeight[tx_size];
+  // Only the top-left 32x32 coefficients can be non-zero.
+  const int coeff_width = std::min(tx_width, 32);
+  const int coeff_height = std::min(tx_height, 32);
+  // The coefficients of an identity transform are not frequencies, so they
+  // are all kept.
+  const int keep_width =
+      (kRowTransform[tx_type] == dsp::k1DTransformIdentity)
+          ? coeff_width
+          : std::min(tx_width >> scale_log2, coeff_width);
+  const int keep_height =
+      (kColumnTransform[tx_type] == dsp::k1DTransformIdentity)
+          ? coeff_height
+          : std::min(tx_height >> scale_log2, coeff_height);
+  for (int y = 0; y < coeff_height; ++y) {
+    const int x = (y < keep_height) ? keep_width : 0;
+    memset(&buffer[y * tx_width + x], 0,
+           (coeff_width - x) * sizeof(buffer[0]));
+  }
+  if (keep_width == 1 && keep_height == 1) return 1;
+  // The thresholds below are the ones used by GetDctSubRegion(). They make
+  // Reconstruct() pick the smallest Dct-Dct transform that covers the kept
+  // coefficients. The other transform types keep |non_zero_coeff_count| since
+  // their row counts depend on the scan order.
+  if (tx_type == kTransformTypeDctDct) {
+    if (keep_width <= 8 && keep_height <= 8) {
+      return std::min(non_zero_coeff_count, 36);
+    }
+    if (keep_width <= 16 && keep_height <= 16) {
+      return std::min(non_zero_coeff_count, 136);
+    }
+  }
+  return non_zero_coeff_count;
+}
+
 template void Reconstruct(const dsp::Dsp& dsp, TransformType tx_type,
                           TransformSize tx_size, bool lossless, int16_t* buffer,
                           int start_x, int start_y, Array2DView<uint8_t>* frame,
@@ -187,4 +264,15 @@ template void Reconstruct(const dsp::Dsp& dsp, TransformType tx_type,
                           int non_zero_coeff_count);
 #endif
 
+template int KeepLowFrequencyCoefficients(TransformType tx_type,
+                                          TransformSize tx_size,
+                                          int scale_log2, int16_t* buffer,
+                                          int non_zero_coeff_count);
+#if LIBGAV1_MAX_BITDEPTH >= 10
+template int KeepLowFrequencyCoefficients(TransformType tx_type,
+                                          TransformSize tx_size,
+                                          int scale_log2, int32_t* buffer,
+                                          int non_zero_coeff_count);
+#endif
+
 }  // namespace libgav1
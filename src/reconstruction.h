@@ -50,5 +50,27 @@ extern template void Reconstruct(const dsp::Dsp& dsp, TransformType tx_type,
                                  int non_zero_coeff_count);
 #endif
 
+// Used by the approximate preview decoding. Zeroes all the coefficients in
+// |buffer| except the ones in the top-left 1 / (1 << |scale_log2|) of each
+// dimension of the |tx_size| block, and returns the |non_zero_coeff_count| to
+// pass to Reconstruct() for the remaining coefficients.
+template <typename Residual>
+int KeepLowFrequencyCoefficients(TransformType tx_type, TransformSize tx_size,
+                                 int scale_log2, Residual* buffer,
+                                 int non_zero_coeff_count);
+
+extern template int KeepLowFrequencyCoefficients(TransformType tx_type,
+                                                 TransformSize tx_size,
+                                                 int scale_log2,
+                                                 int16_t* buffer,
+                                                 int non_zero_coeff_count);
+#if LIBGAV1_MAX_BITDEPTH >= 10
+extern template int KeepLowFrequencyCoefficients(TransformType tx_type,
+                                                 TransformSize tx_size,
+                                                 int scale_log2,
+                                                 int32_t* buffer,
+                                                 int non_zero_coeff_count);
+#endif
+
 }  // namespace libgav1
 #endif  // LIBGAV1_SRC_RECONSTRUCTION_H_
@@ -14,6 +14,8 @@
 
 #include "src/residual_buffer_pool.h"
 
+#include <algorithm>
+#include <cstring>
 #include <mutex>  // NOLINT (unapproved c++11 header)
 #include <utility>
 
@@ -48,8 +50,25 @@ constexpr int kMaxQueueSize[2][2][2] = {
     },
 };
 
+// The initial size of the coefficient storage of a ResidualBuffer. It is
+// doubled as needed.
+constexpr size_t kMinResidualBufferCapacity = 4096;
+
 }  // namespace
 
+bool ResidualBuffer::Reserve(size_t additional_size) {
+  const size_t required_capacity = size_ + additional_size;
+  if (required_capacity <= capacity_) return true;
+  size_t capacity = std::max(capacity_, kMinResidualBufferCapacity);
+  while (capacity < required_capacity) capacity *= 2;
+  std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[capacity]);
+  if (buffer == nullptr) return false;
+  if (size_ != 0) memcpy(buffer.get(), buffer_.get(), size_);
+  buffer_ = std::move(buffer);
+  capacity_ = capacity;
+  return true;
+}
+
 ResidualBufferStack::~ResidualBufferStack() {
   while (top_ != nullptr) {
     ResidualBuffer* top = top_;
@@ -81,29 +100,21 @@ void ResidualBufferStack::Swap(ResidualBufferStack* other) {
 }
 
 ResidualBufferPool::ResidualBufferPool(bool use_128x128_superblock,
-                                       int subsampling_x, int subsampling_y,
-                                       size_t residual_size)
-    : buffer_size_(GetResidualBufferSize(
-          use_128x128_superblock ? 128 : 64, use_128x128_superblock ? 128 : 64,
-          subsampling_x, subsampling_y, residual_size)),
-      queue_size_(kMaxQueueSize[static_cast<int>(use_128x128_superblock)]
+                                       int subsampling_x, int subsampling_y)
+    : queue_size_(kMaxQueueSize[static_cast<int>(use_128x128_superblock)]
                                [subsampling_x][subsampling_y]) {}
 
 void ResidualBufferPool::Reset(bool use_128x128_superblock, int subsampling_x,
-                               int subsampling_y, size_t residual_size) {
-  const size_t buffer_size = GetResidualBufferSize(
-      use_128x128_superblock ? 128 : 64, use_128x128_superblock ? 128 : 64,
-      subsampling_x, subsampling_y, residual_size);
+                               int subsampling_y) {
   const int queue_size = kMaxQueueSize[static_cast<int>(use_128x128_superblock)]
                                       [subsampling_x][subsampling_y];
-  if (buffer_size == buffer_size_ && queue_size == queue_size_) {
+  if (queue_size == queue_size_) {
     // The existing buffers (if any) are still valid, so don't do anything.
     return;
   }
-  buffer_size_ = buffer_size;
   queue_size_ = queue_size;
-  // The existing buffers (if any) are no longer valid since the buffer size or
-  // the queue size has changed. Clear the stack.
+  // The existing buffers (if any) are no longer valid since the queue size has
+  // changed. Clear the stack.
   ResidualBufferStack buffers;
   {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -123,13 +134,13 @@ std::unique_ptr<ResidualBuffer> ResidualBufferPool::Get() {
     buffer = buffers_.Pop();
   }
   if (buffer == nullptr) {
-    buffer = ResidualBuffer::Create(buffer_size_, queue_size_);
+    buffer = ResidualBuffer::Create(queue_size_);
   }
   return buffer;
 }
 
 void ResidualBufferPool::Release(std::unique_ptr<ResidualBuffer> buffer) {
-  buffer->transform_parameters()->Reset();
+  buffer->Reset();
   std::lock_guard<std::mutex> lock(mutex_);
   buffers_.Push(std::move(buffer));
 }
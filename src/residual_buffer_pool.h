@@ -17,8 +17,11 @@
 #ifndef LIBGAV1_SRC_RESIDUAL_BUFFER_POOL_H_
 #define LIBGAV1_SRC_RESIDUAL_BUFFER_POOL_H_
 
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <memory>
 #include <mutex>  // NOLINT (unapproved c++11 header)
 #include <new>
@@ -96,17 +99,19 @@ class TransformParameterQueue {
 
 // This class is used for parsing and decoding a superblock. Members of this
 // class are populated in the "parse" step and consumed in the "decode" step.
+//
+// The coefficients of the transform blocks are packed one after the other:
+// only the coefficients up to the last non-zero one (in the order in which
+// they are stored in the residual buffer) are kept, as int16_t when they all
+// fit. The storage grows with the coefficients that are actually coded instead
+// of being sized for the worst case of a superblock, so the superblocks that
+// are parsed but not yet decoded take little memory.
 class ResidualBuffer : public Allocable {
  public:
-  static std::unique_ptr<ResidualBuffer> Create(size_t buffer_size,
-                                                int queue_size) {
+  static std::unique_ptr<ResidualBuffer> Create(int queue_size) {
     std::unique_ptr<ResidualBuffer> buffer(new (std::nothrow) ResidualBuffer);
-    if (buffer != nullptr) {
-      buffer->buffer_ = MakeAlignedUniquePtr<uint8_t>(32, buffer_size);
-      if (buffer->buffer_ == nullptr ||
-          !buffer->transform_parameters_.Init(queue_size)) {
-        buffer = nullptr;
-      }
+    if (buffer != nullptr && !buffer->transform_parameters_.Init(queue_size)) {
+      buffer = nullptr;
     }
     return buffer;
   }
@@ -115,24 +120,110 @@ class ResidualBuffer : public Allocable {
   ResidualBuffer(ResidualBuffer&& other) = default;
   ResidualBuffer& operator=(ResidualBuffer&& other) = default;
 
-  // Buffer used to store the residual values.
-  uint8_t* buffer() { return buffer_.get(); }
+  // Appends the first |count| coefficients in |residual| as the coefficients
+  // of the next transform block. Returns false if memory allocation fails.
+  template <typename ResidualType>
+  LIBGAV1_MUST_USE_RESULT bool Pack(const ResidualType* residual, int count);
+
+  // Writes the coefficients of the next transform block that was stored by
+  // Pack() into |residual| and sets the rest of the first |size| elements of
+  // |residual| to 0.
+  template <typename ResidualType>
+  void Unpack(int size, ResidualType* residual);
+
   // Queue used to store the transform parameters.
   TransformParameterQueue* transform_parameters() {
     return &transform_parameters_;
   }
 
+  // Clears the coefficients and the transform parameters. The memory is kept.
+  void Reset() {
+    size_ = 0;
+    read_offset_ = 0;
+    transform_parameters_.Reset();
+  }
+
  private:
   friend class ResidualBufferStack;
 
+  // Each transform block starts with a header that holds the number of stored
+  // coefficients (shifted left by 1) and whether they are stored as int32_t
+  // (in bit 0).
+  using Header = uint16_t;
+
   ResidualBuffer() = default;
 
-  AlignedUniquePtr<uint8_t> buffer_;
+  // Makes sure that |additional_size| more bytes can be stored. Returns false
+  // if memory allocation fails.
+  LIBGAV1_MUST_USE_RESULT bool Reserve(size_t additional_size);
+
+  std::unique_ptr<uint8_t[]> buffer_;
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+  size_t read_offset_ = 0;
   TransformParameterQueue transform_parameters_;
   // Used by ResidualBufferStack to form a chain of ResidualBuffers.
   ResidualBuffer* next_ = nullptr;
 };
 
+template <typename ResidualType>
+bool ResidualBuffer::Pack(const ResidualType* const residual, const int count) {
+  assert(count > 0);
+  // int32_t coefficients are narrowed if they all fit in an int16_t.
+  bool narrow = sizeof(ResidualType) > sizeof(int16_t);
+  if (narrow) {
+    for (int i = 0; i < count; ++i) {
+      if (residual[i] < std::numeric_limits<int16_t>::min() ||
+          residual[i] > std::numeric_limits<int16_t>::max()) {
+        narrow = false;
+        break;
+      }
+    }
+  }
+  const size_t coefficient_size =
+      narrow ? sizeof(int16_t) : sizeof(ResidualType);
+  if (!Reserve(sizeof(Header) + count * coefficient_size)) return false;
+  const auto header = static_cast<Header>(
+      (count << 1) | static_cast<int>(coefficient_size == sizeof(int32_t)));
+  memcpy(&buffer_[size_], &header, sizeof(header));
+  size_ += sizeof(header);
+  if (narrow) {
+    for (int i = 0; i < count; ++i) {
+      const auto value = static_cast<int16_t>(residual[i]);
+      memcpy(&buffer_[size_], &value, sizeof(value));
+      size_ += sizeof(value);
+    }
+  } else {
+    memcpy(&buffer_[size_], residual, count * sizeof(residual[0]));
+    size_ += count * sizeof(residual[0]);
+  }
+  return true;
+}
+
+template <typename ResidualType>
+void ResidualBuffer::Unpack(const int size, ResidualType* const residual) {
+  Header header;
+  assert(read_offset_ + sizeof(header) <= size_);
+  memcpy(&header, &buffer_[read_offset_], sizeof(header));
+  read_offset_ += sizeof(header);
+  const int count = header >> 1;
+  assert(count <= size);
+  if ((header & 1) == 0 && sizeof(ResidualType) > sizeof(int16_t)) {
+    for (int i = 0; i < count; ++i) {
+      int16_t value;
+      memcpy(&value, &buffer_[read_offset_], sizeof(value));
+      read_offset_ += sizeof(value);
+      residual[i] = value;
+    }
+  } else {
+    assert((header & 1) == static_cast<int>(sizeof(ResidualType) ==
+                                            sizeof(int32_t)));
+    memcpy(residual, &buffer_[read_offset_], count * sizeof(residual[0]));
+    read_offset_ += count * sizeof(residual[0]);
+  }
+  memset(residual + count, 0, (size - count) * sizeof(residual[0]));
+}
+
 // A LIFO stack of ResidualBuffers. Owns the buffers in the stack.
 class ResidualBufferStack {
  public:
@@ -172,17 +263,16 @@ class ResidualBufferStack {
 class ResidualBufferPool : public Allocable {
  public:
   ResidualBufferPool(bool use_128x128_superblock, int subsampling_x,
-                     int subsampling_y, size_t residual_size);
+                     int subsampling_y);
 
-  // Recomputes |buffer_size_| and invalidates the existing buffers if
+  // Recomputes |queue_size_| and invalidates the existing buffers if
   // necessary.
-  void Reset(bool use_128x128_superblock, int subsampling_x, int subsampling_y,
-             size_t residual_size);
-  // Gets a residual buffer. The buffer is guaranteed to be large enough to
-  // store the residual values for one superblock whose parameters are the same
-  // as the constructor or the last call to Reset(). If there are free buffers
-  // in the stack, it returns one from the stack, otherwise a new buffer is
-  // allocated.
+  void Reset(bool use_128x128_superblock, int subsampling_x, int subsampling_y);
+  // Gets a residual buffer. The buffer's transform parameter queue is
+  // guaranteed to be large enough for one superblock whose parameters are the
+  // same as the constructor or the last call to Reset(). The coefficients are
+  // stored in memory that grows as needed. If there are free buffers in the
+  // stack, it returns one from the stack, otherwise a new buffer is allocated.
   std::unique_ptr<ResidualBuffer> Get();
   // Returns the |buffer| back to the pool (by appending it to the stack).
   // Subsequent calls to Get() may re-use this buffer.
@@ -194,7 +284,6 @@ class ResidualBufferPool : public Allocable {
  private:
   mutable std::mutex mutex_;
   ResidualBufferStack buffers_ LIBGAV1_GUARDED_BY(mutex_);
-  size_t buffer_size_;
   int queue_size_;
 };
 
@@ -19,6 +19,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <memory>
 
 #include "src/dsp/constants.h"
 #include "src/utils/constants.h"
@@ -90,7 +91,7 @@ enum {
   kNumMvComponents = 2,
 };  // anonymous enum
 
-struct SymbolDecoderContext {
+struct SymbolDecoderContext : public MaxAlignedAllocable {
   SymbolDecoderContext() = default;
   explicit SymbolDecoderContext(int base_quantizer_index) {
     Initialize(base_quantizer_index);
@@ -297,5 +298,11 @@ struct SymbolDecoderContext {
                            [kBooleanFieldCdfSize];
 };
 
+// An immutable, reference counted SymbolDecoderContext. A frame's saved CDF
+// tables are shared with the frames that use it as their primary reference
+// frame instead of being copied. Only the tiles, which update the CDFs, make a
+// private copy.
+using SymbolDecoderContextPtr = std::shared_ptr<const SymbolDecoderContext>;
+
 }  // namespace libgav1
 #endif  // LIBGAV1_SRC_SYMBOL_DECODER_CONTEXT_H_
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cassert>
 #include <memory>
+#include <mutex>  // NOLINT (unapproved c++11 header)
 
 #include "src/frame_scratch_buffer.h"
 #include "src/utils/constants.h"
@@ -66,12 +67,14 @@ int ComputeFrameThreadCount(int thread_count, int tile_count,
 }  // namespace
 
 bool ThreadingStrategy::Reset(const ObuFrameHeader& frame_header,
-                              int thread_count) {
+                              int thread_count,
+                              ThreadPool* const shared_thread_pool) {
   assert(thread_count > 0);
   frame_parallel_ = false;
 
   if (thread_count == 1) {
-    thread_pool_.reset(nullptr);
+    owned_thread_pool_.reset(nullptr);
+    thread_pool_ = nullptr;
     tile_thread_count_ = 0;
     max_tile_index_for_row_threads_ = 0;
     return true;
@@ -81,15 +84,23 @@ bool ThreadingStrategy::Reset(const ObuFrameHeader& frame_header,
   // |thread_count|-1 threads in the threadpool.
   thread_count = std::min(thread_count, static_cast<int>(kMaxThreads)) - 1;
 
-  if (thread_pool_ == nullptr || thread_pool_->num_threads() != thread_count) {
-    thread_pool_ = ThreadPool::Create("libgav1", thread_count);
-    if (thread_pool_ == nullptr) {
-      LIBGAV1_DLOG(ERROR, "Failed to create a thread pool with %d threads.",
-                   thread_count);
-      tile_thread_count_ = 0;
-      max_tile_index_for_row_threads_ = 0;
-      return false;
+  if (shared_thread_pool != nullptr) {
+    owned_thread_pool_.reset(nullptr);
+    thread_pool_ = shared_thread_pool;
+  } else {
+    if (owned_thread_pool_ == nullptr ||
+        owned_thread_pool_->num_threads() != thread_count) {
+      thread_pool_ = nullptr;
+      owned_thread_pool_ = ThreadPool::Create("libgav1", thread_count);
+      if (owned_thread_pool_ == nullptr) {
+        LIBGAV1_DLOG(ERROR, "Failed to create a thread pool with %d threads.",
+                     thread_count);
+        tile_thread_count_ = 0;
+        max_tile_index_for_row_threads_ = 0;
+        return false;
+      }
     }
+    thread_pool_ = owned_thread_pool_.get();
   }
 
   // Prefer tile threads first (but only if there is more than one tile).
@@ -159,14 +170,17 @@ bool ThreadingStrategy::Reset(int thread_count) {
   tile_thread_count_ = 0;
   max_tile_index_for_row_threads_ = 0;
 
-  if (thread_pool_ == nullptr || thread_pool_->num_threads() != thread_count) {
-    thread_pool_ = ThreadPool::Create("libgav1-fp", thread_count);
-    if (thread_pool_ == nullptr) {
+  if (owned_thread_pool_ == nullptr ||
+      owned_thread_pool_->num_threads() != thread_count) {
+    thread_pool_ = nullptr;
+    owned_thread_pool_ = ThreadPool::Create("libgav1-fp", thread_count);
+    if (owned_thread_pool_ == nullptr) {
       LIBGAV1_DLOG(ERROR, "Failed to create a thread pool with %d threads.",
                    thread_count);
       return false;
     }
   }
+  thread_pool_ = owned_thread_pool_.get();
   return true;
 }
 
@@ -219,4 +233,26 @@ bool InitializeThreadPoolsForFrameParallel(
   return true;
 }
 
+ThreadPool* GetSharedThreadPool(int thread_count) {
+  // The pool is intentionally leaked so that it remains valid for decoders
+  // that are still alive while static objects are destroyed.
+  static std::mutex mutex;
+  static ThreadPool* shared_thread_pool = nullptr;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (shared_thread_pool == nullptr) {
+    assert(thread_count > 1);
+    thread_count = std::min(thread_count, static_cast<int>(kMaxThreads)) - 1;
+    std::unique_ptr<ThreadPool> thread_pool =
+        ThreadPool::Create("libgav1-sh", thread_count);
+    if (thread_pool == nullptr) {
+      LIBGAV1_DLOG(ERROR,
+                   "Failed to create the shared thread pool with %d threads.",
+                   thread_count);
+      return nullptr;
+    }
+    shared_thread_pool = thread_pool.release();
+  }
+  return shared_thread_pool;
+}
+
 }  // namespace libgav1
@@ -47,10 +47,14 @@ class ThreadingStrategy {
   //   * One thread is allocated for decoding each Tile.
   //   * Any remaining threads are allocated for superblock row multi-threading
   //     within each of the tile in a round robin fashion.
+  // If |shared_thread_pool| is not nullptr, no threads are created and the
+  // jobs are scheduled onto |shared_thread_pool| instead. |thread_count| is
+  // still used to divide the work as described above.
   // Note: During the lifetime of a ThreadingStrategy object, only one of the
   // Reset() variants will be used.
   LIBGAV1_MUST_USE_RESULT bool Reset(const ObuFrameHeader& frame_header,
-                                     int thread_count);
+                                     int thread_count,
+                                     ThreadPool* shared_thread_pool = nullptr);
 
   // Creates or re-allocates a thread pool with |thread_count| threads. This
   // function is used only in frame parallel mode. This function is idempotent
@@ -63,7 +67,7 @@ class ThreadingStrategy {
   // Returns a pointer to the ThreadPool that is to be used for Tile
   // multi-threading.
   ThreadPool* tile_thread_pool() const {
-    return (tile_thread_count_ != 0) ? thread_pool_.get() : nullptr;
+    return (tile_thread_count_ != 0) ? thread_pool_ : nullptr;
   }
 
   int tile_thread_count() const { return tile_thread_count_; }
@@ -71,13 +75,13 @@ class ThreadingStrategy {
   // Returns a pointer to the underlying ThreadPool.
   // Note: Valid only when |frame_parallel_| is true. This is used for
   // facilitating in-frame multi-threading in that case.
-  ThreadPool* thread_pool() const { return thread_pool_.get(); }
+  ThreadPool* thread_pool() const { return thread_pool_; }
 
   // Returns a pointer to the ThreadPool that is to be used within the Tile at
   // index |tile_index| for superblock row multi-threading.
   // Note: Valid only when |frame_parallel_| is false.
   ThreadPool* row_thread_pool(int tile_index) const {
-    return tile_index < max_tile_index_for_row_threads_ ? thread_pool_.get()
+    return tile_index < max_tile_index_for_row_threads_ ? thread_pool_
                                                         : nullptr;
   }
 
@@ -85,16 +89,18 @@ class ThreadingStrategy {
   // multi-threading.
   // Note: Valid only when |frame_parallel_| is false.
   ThreadPool* post_filter_thread_pool() const {
-    return frame_parallel_ ? nullptr : thread_pool_.get();
+    return frame_parallel_ ? nullptr : thread_pool_;
   }
 
   // Returns a pointer to the ThreadPool that is to be used for film grain
   // synthesis and blending.
   // Note: Valid only when |frame_parallel_| is false.
-  ThreadPool* film_grain_thread_pool() const { return thread_pool_.get(); }
+  ThreadPool* film_grain_thread_pool() const { return thread_pool_; }
 
  private:
-  std::unique_ptr<ThreadPool> thread_pool_;
+  std::unique_ptr<ThreadPool> owned_thread_pool_;
+  // Either |owned_thread_pool_| or the shared thread pool passed to Reset().
+  ThreadPool* thread_pool_ = nullptr;
   int tile_thread_count_ = 0;
   int max_tile_index_for_row_threads_ = 0;
   bool frame_parallel_ = false;
@@ -126,6 +132,12 @@ LIBGAV1_MUST_USE_RESULT bool InitializeThreadPoolsForFrameParallel(
     std::unique_ptr<ThreadPool>* frame_thread_pool,
     FrameScratchBufferPool* frame_scratch_buffer_pool);
 
+// Returns the thread pool that is shared by all the decoders created with
+// DecoderSettings::shared_thread_pool set to true. The pool is created with
+// |thread_count| - 1 threads on the first call and is never destroyed, so that
+// it outlives every decoder. Returns nullptr on failure.
+ThreadPool* GetSharedThreadPool(int thread_count);
+
 }  // namespace libgav1
 
 #endif  // LIBGAV1_SRC_THREADING_STRATEGY_H_
@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <condition_variable>  // NOLINT (unapproved c++11 header)
 #include <cstddef>
@@ -74,18 +75,18 @@ class Tile : public Allocable {
       const ObuFrameHeader& frame_header, RefCountedBuffer* const current_frame,
       const DecoderState& state, FrameScratchBuffer* const frame_scratch_buffer,
       const WedgeMaskArray& wedge_masks,
-      const QuantizerMatrix& quantizer_matrix,
+      const QuantizerMatrix* quantizer_matrix,
       SymbolDecoderContext* const saved_symbol_decoder_context,
       const SegmentationMap* prev_segment_ids, PostFilter* const post_filter,
       const dsp::Dsp* const dsp, ThreadPool* const thread_pool,
       BlockingCounterWithStatus* const pending_tiles, bool frame_parallel,
-      bool use_intra_prediction_buffer) {
+      bool use_intra_prediction_buffer, int preview_scale_log2) {
     std::unique_ptr<Tile> tile(new (std::nothrow) Tile(
         tile_number, data, size, sequence_header, frame_header, current_frame,
         state, frame_scratch_buffer, wedge_masks, quantizer_matrix,
         saved_symbol_decoder_context, prev_segment_ids, post_filter, dsp,
         thread_pool, pending_tiles, frame_parallel,
-        use_intra_prediction_buffer));
+        use_intra_prediction_buffer, preview_scale_log2));
     return (tile != nullptr && tile->Init()) ? std::move(tile) : nullptr;
   }
 
@@ -171,6 +172,10 @@ class Tile : public Allocable {
     return block_parameters_holder_.columns4x4();
   }
 
+  const BlockParametersHolder& block_parameters_holder() const {
+    return block_parameters_holder_;
+  }
+
   // Returns true if Parameters() can be called with |row| and |column| as
   // inputs, false otherwise.
   bool HasParameters(int row, int column) const {
@@ -205,38 +210,47 @@ class Tile : public Allocable {
     int depth;
   };
 
-  // Enum to track the processing state of a superblock.
-  enum SuperBlockState : uint8_t {
-    kSuperBlockStateNone,       // Not yet parsed or decoded.
-    kSuperBlockStateParsed,     // Parsed but not yet decoded.
-    kSuperBlockStateScheduled,  // Scheduled for decoding.
-    kSuperBlockStateDecoded     // Parsed and decoded.
+  // Processing state of a superblock row. The superblocks of a row are parsed
+  // and decoded from left to right, so counters are enough to track them.
+  struct SuperBlockRowState {
+    // Number of superblocks in the row that have been parsed.
+    std::atomic<int> parsed_columns{0};
+    // Number of superblocks in the row that have been decoded. Only modified
+    // by the job that owns the row.
+    std::atomic<int> decoded_columns{0};
+    // Whether a job owns the row, i.e. is scheduled to decode it. At most one
+    // job decodes a row at any time.
+    std::atomic<bool> owned{false};
   };
 
   // Parameters used to facilitate multi-threading within the Tile.
   struct ThreadingParameters {
-    std::mutex mutex;
-    // 2d array of size |superblock_rows_| by |superblock_columns_| containing
-    // the processing state of each superblock.
-    Array2D<SuperBlockState> sb_state LIBGAV1_GUARDED_BY(mutex);
+    // Array of size |superblock_rows_| containing the processing state of each
+    // superblock row.
+    std::unique_ptr<SuperBlockRowState[]> sb_row_state;
     // Variable used to indicate either parse or decode failure.
-    bool abort LIBGAV1_GUARDED_BY(mutex) = false;
-    int pending_jobs LIBGAV1_GUARDED_BY(mutex) = 0;
-    std::condition_variable pending_jobs_zero_condvar;
+    std::atomic<bool> abort{false};
+    std::atomic<int> pending_jobs{0};
+  };
+
+  // An above or left neighbor of a block that uses obmc.
+  struct ObmcNeighbor {
+    const BlockParameters* bp;
+    int candidate_row;
+    int candidate_column;
+    // Position (relative to the block) and size of the part of the block edge
+    // that the neighbor overlaps.
+    int offset;
+    int size;
   };
 
-  // The residual pointer is used to traverse the |residual_buffer_|. It is
-  // used in two different ways.
-  // If |split_parse_and_decode_| is true:
-  //    The pointer points to the beginning of the |residual_buffer_| when the
-  //    "parse" and "decode" steps begin. It is then moved forward tx_size in
-  //    each iteration of the "parse" and the "decode" steps. In this case, the
-  //    ResidualPtr variable passed into various functions starting from
-  //    ProcessSuperBlock is used as an in/out parameter to keep track of the
-  //    residual pointer.
-  // If |split_parse_and_decode_| is false:
-  //    The pointer is reset to the beginning of the |residual_buffer_| for
-  //    every transform block.
+  // The residual pointer points to the buffer that holds the residual values of
+  // the current transform block. It is the same for every transform block:
+  //  * In the "parse" step (or when parsing and decoding are done together),
+  //    it points to |residual_buffer_|.
+  //  * In the "decode" step, it points to the |residual| buffer of the
+  //    TileScratchBuffer, into which the values stored in the ResidualBuffer
+  //    of the superblock are unpacked.
   using ResidualPtr = uint8_t*;
 
   Tile(int tile_number, const uint8_t* data, size_t size,
@@ -244,12 +258,12 @@ class Tile : public Allocable {
        const ObuFrameHeader& frame_header, RefCountedBuffer* current_frame,
        const DecoderState& state, FrameScratchBuffer* frame_scratch_buffer,
        const WedgeMaskArray& wedge_masks,
-       const QuantizerMatrix& quantizer_matrix,
+       const QuantizerMatrix* quantizer_matrix,
        SymbolDecoderContext* saved_symbol_decoder_context,
        const SegmentationMap* prev_segment_ids, PostFilter* post_filter,
        const dsp::Dsp* dsp, ThreadPool* thread_pool,
        BlockingCounterWithStatus* pending_tiles, bool frame_parallel,
-       bool use_intra_prediction_buffer);
+       bool use_intra_prediction_buffer, int preview_scale_log2);
 
   // Performs member initializations that may fail. Helper function used by
   // Create().
@@ -259,25 +273,35 @@ class Tile : public Allocable {
   // |saved_symbol_decoder_context_| if necessary.
   void SaveSymbolDecoderContext();
 
+  // Projects the temporal motion field for the superblock row at |row4x4|
+  // within this Tile. This has to be done before the superblock row is parsed.
+  void SetupMotionFieldForSuperBlockRow(int row4x4);
+
   // Entry point for multi-threaded decoding. This function performs the same
   // functionality as ParseAndDecode(). The current thread does the "parse" step
   // while the worker threads do the "decode" step.
   bool ThreadedParseAndDecode();
 
-  // Returns whether or not the prerequisites for decoding the superblock at
-  // |row_index| and |column_index| are satisfied. |threading_.mutex| must be
-  // held when calling this function.
-  bool CanDecode(int row_index, int column_index) const;
+  // Returns whether or not the prerequisites for decoding the next superblock
+  // of the superblock row at |row_index| are satisfied.
+  bool CanDecode(int row_index) const;
+
+  // Schedules a DecodeSuperBlockRow() job for the superblock row at
+  // |row_index| if its next superblock can be decoded and no other job owns
+  // the row.
+  void MaybeScheduleSuperBlockRow(int row_index, int block_width4x4);
 
   // This function is run by the worker threads when multi-threaded decoding is
-  // enabled. Once a superblock is decoded, this function will set the
-  // corresponding |threading_.sb_state| entry to kSuperBlockStateDecoded. On
-  // failure, |threading_.abort| will be set to true. If at any point
-  // |threading_.abort| becomes true, this function will return as early as it
-  // can. If the decoding succeeds, this function will also schedule the
-  // decoding jobs for the superblock to the bottom-left and the superblock to
-  // the right of this superblock (if it is allowed).
-  void DecodeSuperBlock(int row_index, int column_index, int block_width4x4);
+  // enabled. It owns the superblock row at |row_index| and decodes its
+  // superblocks for as long as their prerequisites are satisfied, scheduling
+  // the decoding of the next superblock row as it makes progress. On failure,
+  // |threading_.abort| will be set to true. If at any point |threading_.abort|
+  // becomes true, this function will return as early as it can.
+  void DecodeSuperBlockRow(int row_index, int block_width4x4);
+
+  // Ends a job of ThreadedParseAndDecode(). The last job to end reports the
+  // status of the tile to |pending_tiles_|.
+  void EndThreadedJob();
 
   // If |use_intra_prediction_buffer_| is true, then this function copies the
   // last row of the superblockrow starting at |row4x4| into the
@@ -482,15 +506,22 @@ class Tile : public Allocable {
                             uint16_t* prediction, bool is_compound,
                             bool is_inter_intra, uint8_t* dest,
                             ptrdiff_t dest_stride);  // 7.11.3.4.
+  // Predicts a block that uses intra block copy. The motion vector points to
+  // the already decoded part of the current frame.
+  void IntraBlockCopyPrediction(Plane plane, const MotionVector& mv, int x,
+                                int y, int width, int height, uint8_t* dest,
+                                ptrdiff_t dest_stride);
   bool BlockWarpProcess(const Block& block, Plane plane, int index,
                         int block_start_x, int block_start_y, int width,
                         int height, GlobalMotion* warp_params, bool is_compound,
                         bool is_inter_intra, uint8_t* dest,
                         ptrdiff_t dest_stride);  // 7.11.3.5.
-  bool ObmcBlockPrediction(const Block& block, const MotionVector& mv,
-                           Plane plane, int reference_frame_index, int width,
-                           int height, int x, int y, int candidate_row,
-                           int candidate_column,
+  // Predicts the overlapping parts of |neighbors| along one edge of the block
+  // and blends them into the prediction. |x|, |y|, |width| and |height|
+  // describe the overlapping area of the block.
+  bool ObmcBlockPrediction(const Block& block, Plane plane,
+                           const ObmcNeighbor* neighbors, int num_neighbors,
+                           int x, int y, int width, int height,
                            ObmcDirection blending_direction);
   bool ObmcPrediction(const Block& block, Plane plane, int width,
                       int height);  // 7.11.3.9.
@@ -650,7 +681,7 @@ class Tile : public Allocable {
   TemporalMotionField& motion_field_;
   const std::array<uint8_t, kNumReferenceFrameTypes>& reference_order_hint_;
   const WedgeMaskArray& wedge_masks_;
-  const QuantizerMatrix& quantizer_matrix_;
+  const QuantizerMatrix* const quantizer_matrix_;
   DaalaBitReader reader_;
   SymbolDecoderContext symbol_decoder_context_;
   SymbolDecoderContext* const saved_symbol_decoder_context_;
@@ -659,13 +690,7 @@ class Tile : public Allocable {
   PostFilter& post_filter_;
   BlockParametersHolder& block_parameters_holder_;
   Quantizer quantizer_;
-  // When there is no multi-threading within the Tile, |residual_buffer_| is
-  // used. When there is multi-threading within the Tile,
-  // |residual_buffer_threaded_| is used. In the following comment,
-  // |residual_buffer| refers to either |residual_buffer_| or
-  // |residual_buffer_threaded_| depending on whether multi-threading is enabled
-  // within the Tile or not.
-  // The |residual_buffer| is used to help with the dequantization and the
+  // The |residual_buffer_| is used to help with the dequantization and the
   // inverse transform processes. It is declared as a uint8_t, but is always
   // accessed either as an int16_t or int32_t depending on |bitdepth|. Here is
   // what it stores at various stages of the decoding process (in the order
@@ -673,31 +698,34 @@ class Tile : public Allocable {
   //   1) In ReadTransformCoefficients(), this buffer is used to store the
   //   dequantized values.
   //   2) In Reconstruct(), this buffer is used as the input to the row
-  //   transform process.
-  // The size of this buffer would be:
-  //    For |residual_buffer_|: (4096 + 32 * |kResidualPaddingVertical|) *
-  //        |residual_size_|. Where 4096 = 64x64 which is the maximum transform
-  //        size, and 32 * |kResidualPaddingVertical| is the padding to avoid
-  //        bottom boundary checks when parsing quantized coefficients. This
-  //        memory is allocated and owned by the Tile class.
-  //    For |residual_buffer_threaded_|: See the comment below. This memory is
-  //        not allocated or owned by the Tile class.
+  //   transform process (only when parsing and decoding are done together).
+  // The size of this buffer is (4096 + 32 * |kResidualPaddingVertical|) *
+  // |residual_size_|. Where 4096 = 64x64 which is the maximum transform size,
+  // and 32 * |kResidualPaddingVertical| is the padding to avoid bottom boundary
+  // checks when parsing quantized coefficients.
   AlignedUniquePtr<uint8_t> residual_buffer_;
   // This is a 2d array of pointers of size |superblock_rows_| by
   // |superblock_columns_| where each pointer points to a ResidualBuffer for a
-  // single super block. The array is populated when the parsing process begins
-  // by calling |residual_buffer_pool_->Get()| and the memory is released back
-  // to the pool by calling |residual_buffer_pool_->Release()| when the decoding
-  // process is complete.
+  // single super block. It is used only when parsing and decoding are done
+  // separately. The array is populated when the parsing process begins by
+  // calling |residual_buffer_pool_->Get()|. ReadTransformCoefficients() packs
+  // the dequantized values from |residual_buffer_| into it. The memory is
+  // released back to the pool by calling |residual_buffer_pool_->Release()|
+  // when the decoding process is complete.
   Array2D<std::unique_ptr<ResidualBuffer>> residual_buffer_threaded_;
   // sizeof(int16_t or int32_t) depending on |bitdepth|.
   const size_t residual_size_;
-  // Number of superblocks on the top-right that will have to be decoded before
-  // the current superblock can be decoded. This will be 1 if allow_intrabc is
-  // false. If allow_intrabc is true, then this value will be
-  // use_128x128_superblock ? 3 : 5. This is the allowed range of reference for
-  // the top rows for intrabc.
-  const int intra_block_copy_lag_;
+  // If allow_intrabc is true, a superblock in column c may reference the
+  // superblocks up to column
+  //   c + k * |intra_block_copy_gradient_| - |intra_block_copy_offset_|
+  // of the superblock row that is k rows above it. This is the wavefront
+  // constraint of IsMvValid() expressed in superblocks. The values are
+  // use_128x128_superblock ? 3 : 5 and use_128x128_superblock ? 2 : 5.
+  const int intra_block_copy_gradient_;
+  const int intra_block_copy_offset_;
+  // Number of superblock rows below a superblock row whose decoding may wait
+  // for its progress. This will be 1 if allow_intrabc is false.
+  int dependent_superblock_rows_;
 
   // In the Tile class, we use the "current_frame" in two ways:
   //   1) To write the decoded output into (using the |buffer_| view).
@@ -745,6 +773,10 @@ class Tile : public Allocable {
   // one row buffer for each tile row. This tile will have to use the buffer
   // corresponding to this tile's row.
   IntraPredictionBuffer* const intra_prediction_buffer_;
+  // If nonzero, only the low frequency coefficients of each transform block
+  // are used for the reconstruction. See
+  // DecoderSettings::preview_scale_log2.
+  const int preview_scale_log2_;
   // Stores the progress of the reference frames. This will be used to avoid
   // unnecessary calls into RefCountedBuffer::WaitUntil().
   std::array<int, kNumReferenceFrameTypes> reference_frame_progress_cache_;
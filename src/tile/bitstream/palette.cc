@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <iterator>
@@ -22,7 +23,6 @@
 #include "src/obu_parser.h"
 #include "src/symbol_decoder_context.h"
 #include "src/tile.h"
-#include "src/utils/bit_mask_set.h"
 #include "src/utils/common.h"
 #include "src/utils/constants.h"
 #include "src/utils/entropy_decoder.h"
@@ -30,6 +30,143 @@
 #include "src/utils/types.h"
 
 namespace libgav1 {
+namespace {
+
+// For each mask of colors, the colors that are not in the mask in ascending
+// order, padded with zeros. After the colors of the neighbors have been placed
+// first, the color order is completed with the entry for their mask.
+constexpr uint8_t kPaletteRemainingColors[256][kMaxPaletteSize] = {
+    {0, 1, 2, 3, 4, 5, 6, 7}, {1, 2, 3, 4, 5, 6, 7, 0},
+    {0, 2, 3, 4, 5, 6, 7, 0}, {2, 3, 4, 5, 6, 7, 0, 0},
+    {0, 1, 3, 4, 5, 6, 7, 0}, {1, 3, 4, 5, 6, 7, 0, 0},
+    {0, 3, 4, 5, 6, 7, 0, 0}, {3, 4, 5, 6, 7, 0, 0, 0},
+    {0, 1, 2, 4, 5, 6, 7, 0}, {1, 2, 4, 5, 6, 7, 0, 0},
+    {0, 2, 4, 5, 6, 7, 0, 0}, {2, 4, 5, 6, 7, 0, 0, 0},
+    {0, 1, 4, 5, 6, 7, 0, 0}, {1, 4, 5, 6, 7, 0, 0, 0},
+    {0, 4, 5, 6, 7, 0, 0, 0}, {4, 5, 6, 7, 0, 0, 0, 0},
+    {0, 1, 2, 3, 5, 6, 7, 0}, {1, 2, 3, 5, 6, 7, 0, 0},
+    {0, 2, 3, 5, 6, 7, 0, 0}, {2, 3, 5, 6, 7, 0, 0, 0},
+    {0, 1, 3, 5, 6, 7, 0, 0}, {1, 3, 5, 6, 7, 0, 0, 0},
+    {0, 3, 5, 6, 7, 0, 0, 0}, {3, 5, 6, 7, 0, 0, 0, 0},
+    {0, 1, 2, 5, 6, 7, 0, 0}, {1, 2, 5, 6, 7, 0, 0, 0},
+    {0, 2, 5, 6, 7, 0, 0, 0}, {2, 5, 6, 7, 0, 0, 0, 0},
+    {0, 1, 5, 6, 7, 0, 0, 0}, {1, 5, 6, 7, 0, 0, 0, 0},
+    {0, 5, 6, 7, 0, 0, 0, 0}, {5, 6, 7, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 4, 6, 7, 0}, {1, 2, 3, 4, 6, 7, 0, 0},
+    {0, 2, 3, 4, 6, 7, 0, 0}, {2, 3, 4, 6, 7, 0, 0, 0},
+    {0, 1, 3, 4, 6, 7, 0, 0}, {1, 3, 4, 6, 7, 0, 0, 0},
+    {0, 3, 4, 6, 7, 0, 0, 0}, {3, 4, 6, 7, 0, 0, 0, 0},
+    {0, 1, 2, 4, 6, 7, 0, 0}, {1, 2, 4, 6, 7, 0, 0, 0},
+    {0, 2, 4, 6, 7, 0, 0, 0}, {2, 4, 6, 7, 0, 0, 0, 0},
+    {0, 1, 4, 6, 7, 0, 0, 0}, {1, 4, 6, 7, 0, 0, 0, 0},
+    {0, 4, 6, 7, 0, 0, 0, 0}, {4, 6, 7, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 6, 7, 0, 0}, {1, 2, 3, 6, 7, 0, 0, 0},
+    {0, 2, 3, 6, 7, 0, 0, 0}, {2, 3, 6, 7, 0, 0, 0, 0},
+    {0, 1, 3, 6, 7, 0, 0, 0}, {1, 3, 6, 7, 0, 0, 0, 0},
+    {0, 3, 6, 7, 0, 0, 0, 0}, {3, 6, 7, 0, 0, 0, 0, 0},
+    {0, 1, 2, 6, 7, 0, 0, 0}, {1, 2, 6, 7, 0, 0, 0, 0},
+    {0, 2, 6, 7, 0, 0, 0, 0}, {2, 6, 7, 0, 0, 0, 0, 0},
+    {0, 1, 6, 7, 0, 0, 0, 0}, {1, 6, 7, 0, 0, 0, 0, 0},
+    {0, 6, 7, 0, 0, 0, 0, 0}, {6, 7, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 4, 5, 7, 0}, {1, 2, 3, 4, 5, 7, 0, 0},
+    {0, 2, 3, 4, 5, 7, 0, 0}, {2, 3, 4, 5, 7, 0, 0, 0},
+    {0, 1, 3, 4, 5, 7, 0, 0}, {1, 3, 4, 5, 7, 0, 0, 0},
+    {0, 3, 4, 5, 7, 0, 0, 0}, {3, 4, 5, 7, 0, 0, 0, 0},
+    {0, 1, 2, 4, 5, 7, 0, 0}, {1, 2, 4, 5, 7, 0, 0, 0},
+    {0, 2, 4, 5, 7, 0, 0, 0}, {2, 4, 5, 7, 0, 0, 0, 0},
+    {0, 1, 4, 5, 7, 0, 0, 0}, {1, 4, 5, 7, 0, 0, 0, 0},
+    {0, 4, 5, 7, 0, 0, 0, 0}, {4, 5, 7, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 5, 7, 0, 0}, {1, 2, 3, 5, 7, 0, 0, 0},
+    {0, 2, 3, 5, 7, 0, 0, 0}, {2, 3, 5, 7, 0, 0, 0, 0},
+    {0, 1, 3, 5, 7, 0, 0, 0}, {1, 3, 5, 7, 0, 0, 0, 0},
+    {0, 3, 5, 7, 0, 0, 0, 0}, {3, 5, 7, 0, 0, 0, 0, 0},
+    {0, 1, 2, 5, 7, 0, 0, 0}, {1, 2, 5, 7, 0, 0, 0, 0},
+    {0, 2, 5, 7, 0, 0, 0, 0}, {2, 5, 7, 0, 0, 0, 0, 0},
+    {0, 1, 5, 7, 0, 0, 0, 0}, {1, 5, 7, 0, 0, 0, 0, 0},
+    {0, 5, 7, 0, 0, 0, 0, 0}, {5, 7, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 4, 7, 0, 0}, {1, 2, 3, 4, 7, 0, 0, 0},
+    {0, 2, 3, 4, 7, 0, 0, 0}, {2, 3, 4, 7, 0, 0, 0, 0},
+    {0, 1, 3, 4, 7, 0, 0, 0}, {1, 3, 4, 7, 0, 0, 0, 0},
+    {0, 3, 4, 7, 0, 0, 0, 0}, {3, 4, 7, 0, 0, 0, 0, 0},
+    {0, 1, 2, 4, 7, 0, 0, 0}, {1, 2, 4, 7, 0, 0, 0, 0},
+    {0, 2, 4, 7, 0, 0, 0, 0}, {2, 4, 7, 0, 0, 0, 0, 0},
+    {0, 1, 4, 7, 0, 0, 0, 0}, {1, 4, 7, 0, 0, 0, 0, 0},
+    {0, 4, 7, 0, 0, 0, 0, 0}, {4, 7, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 7, 0, 0, 0}, {1, 2, 3, 7, 0, 0, 0, 0},
+    {0, 2, 3, 7, 0, 0, 0, 0}, {2, 3, 7, 0, 0, 0, 0, 0},
+    {0, 1, 3, 7, 0, 0, 0, 0}, {1, 3, 7, 0, 0, 0, 0, 0},
+    {0, 3, 7, 0, 0, 0, 0, 0}, {3, 7, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 7, 0, 0, 0, 0}, {1, 2, 7, 0, 0, 0, 0, 0},
+    {0, 2, 7, 0, 0, 0, 0, 0}, {2, 7, 0, 0, 0, 0, 0, 0},
+    {0, 1, 7, 0, 0, 0, 0, 0}, {1, 7, 0, 0, 0, 0, 0, 0},
+    {0, 7, 0, 0, 0, 0, 0, 0}, {7, 0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 4, 5, 6, 0}, {1, 2, 3, 4, 5, 6, 0, 0},
+    {0, 2, 3, 4, 5, 6, 0, 0}, {2, 3, 4, 5, 6, 0, 0, 0},
+    {0, 1, 3, 4, 5, 6, 0, 0}, {1, 3, 4, 5, 6, 0, 0, 0},
+    {0, 3, 4, 5, 6, 0, 0, 0}, {3, 4, 5, 6, 0, 0, 0, 0},
+    {0, 1, 2, 4, 5, 6, 0, 0}, {1, 2, 4, 5, 6, 0, 0, 0},
+    {0, 2, 4, 5, 6, 0, 0, 0}, {2, 4, 5, 6, 0, 0, 0, 0},
+    {0, 1, 4, 5, 6, 0, 0, 0}, {1, 4, 5, 6, 0, 0, 0, 0},
+    {0, 4, 5, 6, 0, 0, 0, 0}, {4, 5, 6, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 5, 6, 0, 0}, {1, 2, 3, 5, 6, 0, 0, 0},
+    {0, 2, 3, 5, 6, 0, 0, 0}, {2, 3, 5, 6, 0, 0, 0, 0},
+    {0, 1, 3, 5, 6, 0, 0, 0}, {1, 3, 5, 6, 0, 0, 0, 0},
+    {0, 3, 5, 6, 0, 0, 0, 0}, {3, 5, 6, 0, 0, 0, 0, 0},
+    {0, 1, 2, 5, 6, 0, 0, 0}, {1, 2, 5, 6, 0, 0, 0, 0},
+    {0, 2, 5, 6, 0, 0, 0, 0}, {2, 5, 6, 0, 0, 0, 0, 0},
+    {0, 1, 5, 6, 0, 0, 0, 0}, {1, 5, 6, 0, 0, 0, 0, 0},
+    {0, 5, 6, 0, 0, 0, 0, 0}, {5, 6, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 4, 6, 0, 0}, {1, 2, 3, 4, 6, 0, 0, 0},
+    {0, 2, 3, 4, 6, 0, 0, 0}, {2, 3, 4, 6, 0, 0, 0, 0},
+    {0, 1, 3, 4, 6, 0, 0, 0}, {1, 3, 4, 6, 0, 0, 0, 0},
+    {0, 3, 4, 6, 0, 0, 0, 0}, {3, 4, 6, 0, 0, 0, 0, 0},
+    {0, 1, 2, 4, 6, 0, 0, 0}, {1, 2, 4, 6, 0, 0, 0, 0},
+    {0, 2, 4, 6, 0, 0, 0, 0}, {2, 4, 6, 0, 0, 0, 0, 0},
+    {0, 1, 4, 6, 0, 0, 0, 0}, {1, 4, 6, 0, 0, 0, 0, 0},
+    {0, 4, 6, 0, 0, 0, 0, 0}, {4, 6, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 6, 0, 0, 0}, {1, 2, 3, 6, 0, 0, 0, 0},
+    {0, 2, 3, 6, 0, 0, 0, 0}, {2, 3, 6, 0, 0, 0, 0, 0},
+    {0, 1, 3, 6, 0, 0, 0, 0}, {1, 3, 6, 0, 0, 0, 0, 0},
+    {0, 3, 6, 0, 0, 0, 0, 0}, {3, 6, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 6, 0, 0, 0, 0}, {1, 2, 6, 0, 0, 0, 0, 0},
+    {0, 2, 6, 0, 0, 0, 0, 0}, {2, 6, 0, 0, 0, 0, 0, 0},
+    {0, 1, 6, 0, 0, 0, 0, 0}, {1, 6, 0, 0, 0, 0, 0, 0},
+    {0, 6, 0, 0, 0, 0, 0, 0}, {6, 0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 4, 5, 0, 0}, {1, 2, 3, 4, 5, 0, 0, 0},
+    {0, 2, 3, 4, 5, 0, 0, 0}, {2, 3, 4, 5, 0, 0, 0, 0},
+    {0, 1, 3, 4, 5, 0, 0, 0}, {1, 3, 4, 5, 0, 0, 0, 0},
+    {0, 3, 4, 5, 0, 0, 0, 0}, {3, 4, 5, 0, 0, 0, 0, 0},
+    {0, 1, 2, 4, 5, 0, 0, 0}, {1, 2, 4, 5, 0, 0, 0, 0},
+    {0, 2, 4, 5, 0, 0, 0, 0}, {2, 4, 5, 0, 0, 0, 0, 0},
+    {0, 1, 4, 5, 0, 0, 0, 0}, {1, 4, 5, 0, 0, 0, 0, 0},
+    {0, 4, 5, 0, 0, 0, 0, 0}, {4, 5, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 5, 0, 0, 0}, {1, 2, 3, 5, 0, 0, 0, 0},
+    {0, 2, 3, 5, 0, 0, 0, 0}, {2, 3, 5, 0, 0, 0, 0, 0},
+    {0, 1, 3, 5, 0, 0, 0, 0}, {1, 3, 5, 0, 0, 0, 0, 0},
+    {0, 3, 5, 0, 0, 0, 0, 0}, {3, 5, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 5, 0, 0, 0, 0}, {1, 2, 5, 0, 0, 0, 0, 0},
+    {0, 2, 5, 0, 0, 0, 0, 0}, {2, 5, 0, 0, 0, 0, 0, 0},
+    {0, 1, 5, 0, 0, 0, 0, 0}, {1, 5, 0, 0, 0, 0, 0, 0},
+    {0, 5, 0, 0, 0, 0, 0, 0}, {5, 0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 4, 0, 0, 0}, {1, 2, 3, 4, 0, 0, 0, 0},
+    {0, 2, 3, 4, 0, 0, 0, 0}, {2, 3, 4, 0, 0, 0, 0, 0},
+    {0, 1, 3, 4, 0, 0, 0, 0}, {1, 3, 4, 0, 0, 0, 0, 0},
+    {0, 3, 4, 0, 0, 0, 0, 0}, {3, 4, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 4, 0, 0, 0, 0}, {1, 2, 4, 0, 0, 0, 0, 0},
+    {0, 2, 4, 0, 0, 0, 0, 0}, {2, 4, 0, 0, 0, 0, 0, 0},
+    {0, 1, 4, 0, 0, 0, 0, 0}, {1, 4, 0, 0, 0, 0, 0, 0},
+    {0, 4, 0, 0, 0, 0, 0, 0}, {4, 0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 3, 0, 0, 0, 0}, {1, 2, 3, 0, 0, 0, 0, 0},
+    {0, 2, 3, 0, 0, 0, 0, 0}, {2, 3, 0, 0, 0, 0, 0, 0},
+    {0, 1, 3, 0, 0, 0, 0, 0}, {1, 3, 0, 0, 0, 0, 0, 0},
+    {0, 3, 0, 0, 0, 0, 0, 0}, {3, 0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 2, 0, 0, 0, 0, 0}, {1, 2, 0, 0, 0, 0, 0, 0},
+    {0, 2, 0, 0, 0, 0, 0, 0}, {2, 0, 0, 0, 0, 0, 0, 0},
+    {0, 1, 0, 0, 0, 0, 0, 0}, {1, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0}, {0, 0, 0, 0, 0, 0, 0, 0},
+};
+
+}  // namespace
 
 int Tile::GetPaletteCache(const Block& block, PlaneType plane_type,
                           uint16_t* const cache) {
@@ -175,71 +312,69 @@ void Tile::PopulatePaletteColorContexts(
     const Block& block, PlaneType plane_type, int i, int start, int end,
     uint8_t color_order[kMaxPaletteSquare][kMaxPaletteSize],
     uint8_t color_context[kMaxPaletteSquare]) {
-  const PredictionParameters& prediction_parameters =
-      *block.bp->prediction_parameters;
-  for (int column = start, counter = 0; column >= end; --column, ++counter) {
+  const Array2D<uint8_t>& color_index_map =
+      block.bp->prediction_parameters->color_index_map[plane_type];
+  const ptrdiff_t stride = color_index_map.columns();
+  // Consecutive entries of the diagonal are one row down and one column to the
+  // left of each other.
+  const uint8_t* current = &color_index_map[i - start][start];
+  for (int column = start, counter = 0; column >= end;
+       --column, ++counter, current += stride - 1) {
     const int row = i - column;
     assert(row > 0 || column > 0);
-    const uint8_t top =
-        (row > 0)
-            ? prediction_parameters.color_index_map[plane_type][row - 1][column]
-            : 0;
-    const uint8_t left =
-        (column > 0)
-            ? prediction_parameters.color_index_map[plane_type][row][column - 1]
-            : 0;
+    uint8_t* const order = color_order[counter];
     uint8_t index_mask;
-    static_assert(kMaxPaletteSize <= 8, "");
     int index;
     if (column <= 0) {
+      const uint8_t top = current[-stride];
       color_context[counter] = 0;
-      color_order[counter][0] = top;
+      order[0] = top;
       index_mask = 1 << top;
       index = 1;
     } else if (row <= 0) {
+      const uint8_t left = current[-1];
       color_context[counter] = 0;
-      color_order[counter][0] = left;
+      order[0] = left;
       index_mask = 1 << left;
       index = 1;
     } else {
-      const uint8_t top_left =
-          prediction_parameters
-              .color_index_map[plane_type][row - 1][column - 1];
+      const uint8_t top = current[-stride];
+      const uint8_t left = current[-1];
+      const uint8_t top_left = current[-stride - 1];
       index_mask = (1 << top) | (1 << left) | (1 << top_left);
       if (top == left && top == top_left) {
         color_context[counter] = 4;
-        color_order[counter][0] = top;
+        order[0] = top;
         index = 1;
       } else if (top == left) {
         color_context[counter] = 3;
-        color_order[counter][0] = top;
-        color_order[counter][1] = top_left;
+        order[0] = top;
+        order[1] = top_left;
         index = 2;
       } else if (top == top_left) {
         color_context[counter] = 2;
-        color_order[counter][0] = top_left;
-        color_order[counter][1] = left;
+        order[0] = top_left;
+        order[1] = left;
         index = 2;
       } else if (left == top_left) {
         color_context[counter] = 2;
-        color_order[counter][0] = top_left;
-        color_order[counter][1] = top;
+        order[0] = top_left;
+        order[1] = top;
         index = 2;
       } else {
         color_context[counter] = 1;
-        color_order[counter][0] = std::min(top, left);
-        color_order[counter][1] = std::max(top, left);
-        color_order[counter][2] = top_left;
+        order[0] = std::min(top, left);
+        order[1] = std::max(top, left);
+        order[2] = top_left;
         index = 3;
       }
     }
-    // Even though only the first |palette_size| entries of this array are ever
-    // used, it is faster to populate all 8 because of the vectorization of the
-    // constant sized loop.
-    for (uint8_t j = 0; j < kMaxPaletteSize; ++j) {
-      if (BitMaskSet::MaskContainsValue(index_mask, j)) continue;
-      color_order[counter][index++] = j;
-    }
+    // |index| is the number of colors in |index_mask|. Even though only the
+    // first |palette_size| entries of |order| are ever used, all of them are
+    // populated.
+    static_assert(kMaxPaletteSize <= 8, "");
+    memcpy(&order[index], kPaletteRemainingColors[index_mask],
+           kMaxPaletteSize - index);
   }
 }
 
@@ -508,24 +508,19 @@ template <typename Pixel>
 void Tile::PalettePrediction(const Block& block, const Plane plane,
                              const int start_x, const int start_y, const int x,
                              const int y, const TransformSize tx_size) {
-  const int tx_width = kTransformWidth[tx_size];
-  const int tx_height = kTransformHeight[tx_size];
-  const uint16_t* const palette = block.bp->palette_mode_info.color[plane];
   const PlaneType plane_type = GetPlaneType(plane);
+  const Array2D<uint8_t>& color_index_map =
+      block.bp->prediction_parameters->color_index_map[plane_type];
   const int x4 = MultiplyBy4(x);
   const int y4 = MultiplyBy4(y);
+  assert(color_index_map[y4] != nullptr);
   Array2DView<Pixel> buffer(buffer_[plane].rows(),
                             buffer_[plane].columns() / sizeof(Pixel),
                             reinterpret_cast<Pixel*>(&buffer_[plane][0][0]));
-  for (int row = 0; row < tx_height; ++row) {
-    assert(block.bp->prediction_parameters
-               ->color_index_map[plane_type][y4 + row] != nullptr);
-    for (int column = 0; column < tx_width; ++column) {
-      buffer[start_y + row][start_x + column] =
-          palette[block.bp->prediction_parameters
-                      ->color_index_map[plane_type][y4 + row][x4 + column]];
-    }
-  }
+  dsp_.palette_predictor(&buffer[start_y][start_x], buffer_[plane].columns(),
+                         &color_index_map[y4][x4], color_index_map.columns(),
+                         block.bp->palette_mode_info.color[plane],
+                         kTransformWidth[tx_size], kTransformHeight[tx_size]);
 }
 
 template void Tile::PalettePrediction<uint8_t>(
@@ -737,12 +732,17 @@ bool Tile::InterPrediction(const Block& block, const Plane plane, const int x,
                             is_inter_intra, dest, dest_stride)) {
         return false;
       }
+    } else if (prediction_parameters.use_intra_block_copy) {
+      // Intra block copy is only used with a single reference and without
+      // inter-intra, so the prediction is written to |dest| directly.
+      assert(!is_compound && !is_inter_intra);
+      IntraBlockCopyPrediction(plane, bp_reference.mv.mv[index], x, y,
+                               prediction_width, prediction_height, dest,
+                               dest_stride);
     } else {
       const int reference_index =
-          prediction_parameters.use_intra_block_copy
-              ? -1
-              : frame_header_.reference_frame_index[reference_type -
-                                                    kReferenceFrameLast];
+          frame_header_.reference_frame_index[reference_type -
+                                              kReferenceFrameLast];
       if (!BlockInterPrediction(
               block, plane, reference_index, bp_reference.mv.mv[index], x, y,
               prediction_width, prediction_height, candidate_row,
@@ -810,36 +810,85 @@ bool Tile::InterPrediction(const Block& block, const Plane plane, const int x,
   return true;
 }
 
-bool Tile::ObmcBlockPrediction(const Block& block, const MotionVector& mv,
-                               const Plane plane,
-                               const int reference_frame_index, const int width,
-                               const int height, const int x, const int y,
-                               const int candidate_row,
-                               const int candidate_column,
+bool Tile::ObmcBlockPrediction(const Block& block, const Plane plane,
+                               const ObmcNeighbor* const neighbors,
+                               const int num_neighbors, const int x,
+                               const int y, const int width, const int height,
                                const ObmcDirection blending_direction) {
   const int bitdepth = sequence_header_.color_config.bitdepth;
+  const int pixel_size = (bitdepth == 8) ? sizeof(uint8_t) : sizeof(uint16_t);
+  const bool is_vertical = blending_direction == kObmcDirectionVertical;
   // Obmc's prediction needs to be clipped before blending with above/left
   // prediction blocks.
   // Obmc prediction is used only when is_compound is false. So it is safe to
   // use prediction_buffer[1] as a temporary buffer for the Obmc prediction.
+  // The predictions of all the neighbors are stored next to each other so
+  // that they cover the overlapping area.
   static_assert(sizeof(block.scratch_buffer->prediction_buffer[1]) >=
                     64 * 64 * sizeof(uint16_t),
                 "");
   auto* const obmc_buffer =
       reinterpret_cast<uint8_t*>(block.scratch_buffer->prediction_buffer[1]);
-  const ptrdiff_t obmc_buffer_stride =
-      (bitdepth == 8) ? width : width * sizeof(uint16_t);
-  if (!BlockInterPrediction(block, plane, reference_frame_index, mv, x, y,
-                            width, height, candidate_row, candidate_column,
-                            nullptr, false, false, obmc_buffer,
-                            obmc_buffer_stride)) {
-    return false;
+  const ptrdiff_t obmc_buffer_stride = width * pixel_size;
+  const ptrdiff_t obmc_buffer_step =
+      is_vertical ? pixel_size : obmc_buffer_stride;
+
+  // Adjacent neighbors that have the same motion vector, reference frame and
+  // interpolation filters are predicted with a single convolve call. The
+  // sizes are powers of two, so only a neighbor of the same size as the
+  // merged ones is merged, which keeps the size a power of two as expected
+  // by the dsp functions. Sizes of 4 or less are not merged because they use
+  // different filters than larger sizes.
+  for (int i = 0; i < num_neighbors;) {
+    const ObmcNeighbor& neighbor = neighbors[i];
+    const BlockParameters& bp = *neighbor.bp;
+    const int reference_frame_index =
+        frame_header_.reference_frame_index[bp.reference_frame[0] -
+                                            kReferenceFrameLast];
+    int size = neighbor.size;
+    for (++i; i < num_neighbors; ++i) {
+      const ObmcNeighbor& next = neighbors[i];
+      if (size <= 4 || next.size != size ||
+          next.offset != neighbor.offset + size ||
+          next.bp->reference_frame[0] != bp.reference_frame[0] ||
+          !(next.bp->mv.mv[0] == bp.mv.mv[0]) ||
+          next.bp->interpolation_filter[0] != bp.interpolation_filter[0] ||
+          next.bp->interpolation_filter[1] != bp.interpolation_filter[1] ||
+          IsScaled(bp.reference_frame[0])) {
+        break;
+      }
+      size *= 2;
+    }
+    if (!BlockInterPrediction(
+            block, plane, reference_frame_index, bp.mv.mv[0],
+            is_vertical ? x + neighbor.offset : x,
+            is_vertical ? y : y + neighbor.offset, is_vertical ? size : width,
+            is_vertical ? height : size, neighbor.candidate_row,
+            neighbor.candidate_column, nullptr, false, false,
+            obmc_buffer + neighbor.offset * obmc_buffer_step,
+            obmc_buffer_stride)) {
+      return false;
+    }
   }
 
+  // Adjacent overlapping areas are blended together, merged the same way.
   uint8_t* const prediction = GetStartPoint(buffer_, plane, x, y, bitdepth);
   const ptrdiff_t prediction_stride = buffer_[plane].columns();
-  dsp_.obmc_blend[blending_direction](prediction, prediction_stride, width,
-                                      height, obmc_buffer, obmc_buffer_stride);
+  const ptrdiff_t prediction_step =
+      is_vertical ? pixel_size : prediction_stride;
+  for (int i = 0; i < num_neighbors;) {
+    const int offset = neighbors[i].offset;
+    int size = neighbors[i].size;
+    for (++i; i < num_neighbors && neighbors[i].size == size &&
+              neighbors[i].offset == offset + size;
+         ++i) {
+      size *= 2;
+    }
+    dsp_.obmc_blend[blending_direction](
+        prediction + offset * prediction_step, prediction_stride,
+        is_vertical ? size : width, is_vertical ? height : size,
+        obmc_buffer + offset * obmc_buffer_step, obmc_buffer_stride);
+  }
   return true;
 }
 
@@ -847,16 +896,19 @@ bool Tile::ObmcPrediction(const Block& block, const Plane plane,
                           const int width, const int height) {
   const int subsampling_x = subsampling_x_[plane];
   const int subsampling_y = subsampling_y_[plane];
+  const int block_start_x = MultiplyBy4(block.column4x4) >> subsampling_x;
+  const int block_start_y = MultiplyBy4(block.row4x4) >> subsampling_y;
+  ObmcNeighbor neighbors[4];
   if (block.top_available[kPlaneY] &&
       !IsBlockSmallerThan8x8(block.residual_size[plane])) {
     const int num_limit = std::min(uint8_t{4}, k4x4WidthLog2[block.size]);
     const int column4x4_max =
         std::min(block.column4x4 + block.width4x4, frame_header_.columns4x4);
     const int candidate_row = block.row4x4 - 1;
-    const int block_start_y = MultiplyBy4(block.row4x4) >> subsampling_y;
     int column4x4 = block.column4x4;
     const int prediction_height = std::min(height >> 1, 32 >> subsampling_y);
-    for (int i = 0, step; i < num_limit && column4x4 < column4x4_max;
+    int num_neighbors = 0;
+    for (int step; num_neighbors < num_limit && column4x4 < column4x4_max;
          column4x4 += step) {
       const int candidate_column = column4x4 | 1;
       const BlockParameters& bp_top =
@@ -864,21 +916,21 @@ bool Tile::ObmcPrediction(const Block& block, const Plane plane,
       const int candidate_block_size = bp_top.size;
       step = Clip3(kNum4x4BlocksWide[candidate_block_size], 2, 16);
       if (bp_top.reference_frame[0] > kReferenceFrameIntra) {
-        i++;
-        const int candidate_reference_frame_index =
-            frame_header_.reference_frame_index[bp_top.reference_frame[0] -
-                                                kReferenceFrameLast];
-        const int prediction_width =
-            std::min(width, MultiplyBy4(step) >> subsampling_x);
-        if (!ObmcBlockPrediction(
-                block, bp_top.mv.mv[0], plane, candidate_reference_frame_index,
-                prediction_width, prediction_height,
-                MultiplyBy4(column4x4) >> subsampling_x, block_start_y,
-                candidate_row, candidate_column, kObmcDirectionVertical)) {
-          return false;
-        }
+        ObmcNeighbor& neighbor = neighbors[num_neighbors++];
+        neighbor.bp = &bp_top;
+        neighbor.candidate_row = candidate_row;
+        neighbor.candidate_column = candidate_column;
+        neighbor.offset = (MultiplyBy4(column4x4) >> subsampling_x) -
+                          block_start_x;
+        neighbor.size = std::min(width, MultiplyBy4(step) >> subsampling_x);
       }
     }
+    if (num_neighbors != 0 &&
+        !ObmcBlockPrediction(block, plane, neighbors, num_neighbors,
+                             block_start_x, block_start_y, width,
+                             prediction_height, kObmcDirectionVertical)) {
+      return false;
+    }
   }
 
   if (block.left_available[kPlaneY]) {
@@ -887,9 +939,9 @@ bool Tile::ObmcPrediction(const Block& block, const Plane plane,
         std::min(block.row4x4 + block.height4x4, frame_header_.rows4x4);
     const int candidate_column = block.column4x4 - 1;
     int row4x4 = block.row4x4;
-    const int block_start_x = MultiplyBy4(block.column4x4) >> subsampling_x;
     const int prediction_width = std::min(width >> 1, 32 >> subsampling_x);
-    for (int i = 0, step; i < num_limit && row4x4 < row4x4_max;
+    int num_neighbors = 0;
+    for (int step; num_neighbors < num_limit && row4x4 < row4x4_max;
          row4x4 += step) {
       const int candidate_row = row4x4 | 1;
       const BlockParameters& bp_left =
@@ -897,21 +949,21 @@ bool Tile::ObmcPrediction(const Block& block, const Plane plane,
       const int candidate_block_size = bp_left.size;
       step = Clip3(kNum4x4BlocksHigh[candidate_block_size], 2, 16);
       if (bp_left.reference_frame[0] > kReferenceFrameIntra) {
-        i++;
-        const int candidate_reference_frame_index =
-            frame_header_.reference_frame_index[bp_left.reference_frame[0] -
-                                                kReferenceFrameLast];
-        const int prediction_height =
-            std::min(height, MultiplyBy4(step) >> subsampling_y);
-        if (!ObmcBlockPrediction(
-                block, bp_left.mv.mv[0], plane, candidate_reference_frame_index,
-                prediction_width, prediction_height, block_start_x,
-                MultiplyBy4(row4x4) >> subsampling_y, candidate_row,
-                candidate_column, kObmcDirectionHorizontal)) {
-          return false;
-        }
+        ObmcNeighbor& neighbor = neighbors[num_neighbors++];
+        neighbor.bp = &bp_left;
+        neighbor.candidate_row = candidate_row;
+        neighbor.candidate_column = candidate_column;
+        neighbor.offset =
+            (MultiplyBy4(row4x4) >> subsampling_y) - block_start_y;
+        neighbor.size = std::min(height, MultiplyBy4(step) >> subsampling_y);
       }
     }
+    if (num_neighbors != 0 &&
+        !ObmcBlockPrediction(block, plane, neighbors, num_neighbors,
+                             block_start_x, block_start_y, prediction_width,
+                             height, kObmcDirectionHorizontal)) {
+      return false;
+    }
   }
   return true;
 }
@@ -1277,6 +1329,37 @@ bool Tile::BlockInterPrediction(
   return true;
 }
 
+void Tile::IntraBlockCopyPrediction(const Plane plane, const MotionVector& mv,
+                                    const int x, const int y, const int width,
+                                    const int height, uint8_t* const dest,
+                                    const ptrdiff_t dest_stride) {
+  // The current frame is never scaled and IsMvValid() keeps the reference
+  // block inside the tile, so neither the scaling nor the border extension of
+  // BlockInterPrediction() is needed. The motion vector is in whole luma
+  // pixels, so only the subsampled planes may be at a half pixel position.
+  const int position_x =
+      (x << kSubPixelBits) + ((2 * mv.mv[1]) >> subsampling_x_[plane]);
+  const int position_y =
+      (y << kSubPixelBits) + ((2 * mv.mv[0]) >> subsampling_y_[plane]);
+  const int horizontal_filter_id = position_x & kSubPixelMask;
+  const int vertical_filter_id = position_y & kSubPixelMask;
+  const YuvBuffer* const reference_buffer = current_frame_.buffer();
+  const int pixel_size =
+      (sequence_header_.color_config.bitdepth == 8) ? sizeof(uint8_t)
+                                                    : sizeof(uint16_t);
+  const uint8_t* const block_start =
+      reference_buffer->data(plane) +
+      (position_y >> kSubPixelBits) * reference_buffer->stride(plane) +
+      (position_x >> kSubPixelBits) * pixel_size;
+  const dsp::ConvolveFunc convolve_func =
+      dsp_.convolve[1][0][vertical_filter_id != 0][horizontal_filter_id != 0];
+  assert(convolve_func != nullptr);
+  convolve_func(block_start, reference_buffer->stride(plane),
+                /*horizontal_filter_index=*/0, /*vertical_filter_index=*/0,
+                horizontal_filter_id, vertical_filter_id, width, height, dest,
+                dest_stride);
+}
+
 bool Tile::BlockWarpProcess(const Block& block, const Plane plane,
                             const int index, const int block_start_x,
                             const int block_start_y, const int width,
@@ -1302,20 +1385,18 @@ bool Tile::BlockWarpProcess(const Block& block, const Plane plane,
   // and available for referencing.
   if (frame_parallel_) {
     int reference_y_max = -1;
-    // Find out the maximum y-coordinate for warping.
-    for (int start_y = block_start_y; start_y < block_start_y + height;
-         start_y += 8) {
-      for (int start_x = block_start_x; start_x < block_start_x + width;
-           start_x += 8) {
-        const int src_x = (start_x + 4) << subsampling_x_[plane];
-        const int src_y = (start_y + 4) << subsampling_y_[plane];
-        const int dst_y = src_x * warp_params->params[4] +
-                          src_y * warp_params->params[5] +
-                          warp_params->params[1];
-        const int y4 = dst_y >> subsampling_y_[plane];
-        const int iy4 = y4 >> kWarpedModelPrecisionBits;
-        reference_y_max = std::max(iy4 + 8, reference_y_max);
-      }
+    // Find out the maximum y-coordinate for warping. It is an affine function
+    // of the position of the 8x8 blocks, so it is reached at a corner block.
+    for (int i = 0; i < 4; ++i) {
+      const int start_x = block_start_x + (((i & 1) != 0) ? width - 8 : 0);
+      const int start_y = block_start_y + (((i & 2) != 0) ? height - 8 : 0);
+      const int src_x = (start_x + 4) << subsampling_x_[plane];
+      const int src_y = (start_y + 4) << subsampling_y_[plane];
+      const int dst_y = src_x * warp_params->params[4] +
+                        src_y * warp_params->params[5] + warp_params->params[1];
+      const int y4 = dst_y >> subsampling_y_[plane];
+      const int iy4 = y4 >> kWarpedModelPrecisionBits;
+      reference_y_max = std::max(iy4 + 8, reference_y_max);
     }
     // For U and V planes with subsampling, we need to multiply reference_y_max
     // by 2 since we only track the progress of Y planes.
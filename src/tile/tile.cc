@@ -87,6 +87,11 @@ constexpr uint8_t kAllZeroContextsByTopLeft[5][5] = {{1, 2, 2, 2, 3},
 //                                 stack.
 constexpr int kDfsStackSize = 16;
 
+// Minimum number of parsed superblocks that have to be waiting to be decoded
+// before the parsing job schedules the decoding of a superblock row in
+// Tile::ThreadedParseAndDecode().
+constexpr int kSuperBlockRunLength = 4;
+
 // Mask indicating whether the transform sets contain a particular transform
 // type. If |tx_type| is present in |tx_set|, then the |tx_type|th LSB is set.
 constexpr BitMaskSet kTransformTypeInSetMask[kNumTransformSets] = {
@@ -419,13 +424,13 @@ Tile::Tile(int tile_number, const uint8_t* const data, size_t size,
            RefCountedBuffer* const current_frame, const DecoderState& state,
            FrameScratchBuffer* const frame_scratch_buffer,
            const WedgeMaskArray& wedge_masks,
-           const QuantizerMatrix& quantizer_matrix,
+           const QuantizerMatrix* quantizer_matrix,
            SymbolDecoderContext* const saved_symbol_decoder_context,
            const SegmentationMap* prev_segment_ids,
            PostFilter* const post_filter, const dsp::Dsp* const dsp,
            ThreadPool* const thread_pool,
            BlockingCounterWithStatus* const pending_tiles, bool frame_parallel,
-           bool use_intra_prediction_buffer)
+           bool use_intra_prediction_buffer, int preview_scale_log2)
     : number_(tile_number),
       row_(number_ / frame_header.tile_info.tile_columns),
       column_(number_ % frame_header.tile_info.tile_columns),
@@ -446,7 +451,7 @@ Tile::Tile(int tile_number, const uint8_t* const data, size_t size,
       wedge_masks_(wedge_masks),
       quantizer_matrix_(quantizer_matrix),
       reader_(data_, size_, frame_header_.enable_cdf_update),
-      symbol_decoder_context_(frame_scratch_buffer->symbol_decoder_context),
+      symbol_decoder_context_(*frame_scratch_buffer->symbol_decoder_context),
       saved_symbol_decoder_context_(saved_symbol_decoder_context),
       prev_segment_ids_(prev_segment_ids),
       dsp_(*dsp),
@@ -457,10 +462,9 @@ Tile::Tile(int tile_number, const uint8_t* const data, size_t size,
       residual_size_((sequence_header_.color_config.bitdepth == 8)
                          ? sizeof(int16_t)
                          : sizeof(int32_t)),
-      intra_block_copy_lag_(
-          frame_header_.allow_intrabc
-              ? (sequence_header_.use_128x128_superblock ? 3 : 5)
-              : 1),
+      intra_block_copy_gradient_(
+          sequence_header_.use_128x128_superblock ? 3 : 5),
+      intra_block_copy_offset_(sequence_header_.use_128x128_superblock ? 2 : 5),
       current_frame_(*current_frame),
       cdef_index_(frame_scratch_buffer->cdef_index),
       inter_transform_sizes_(frame_scratch_buffer->inter_transform_sizes),
@@ -474,7 +478,8 @@ Tile::Tile(int tile_number, const uint8_t* const data, size_t size,
       intra_prediction_buffer_(
           use_intra_prediction_buffer_
               ? &frame_scratch_buffer->intra_prediction_buffers.get()[row_]
-              : nullptr) {
+              : nullptr),
+      preview_scale_log2_(preview_scale_log2) {
   row4x4_start_ = frame_header.tile_info.tile_row_start[row_];
   row4x4_end_ = frame_header.tile_info.tile_row_start[row_ + 1];
   column4x4_start_ = frame_header.tile_info.tile_column_start[column_];
@@ -486,16 +491,25 @@ Tile::Tile(int tile_number, const uint8_t* const data, size_t size,
   superblock_columns_ =
       (column4x4_end_ - column4x4_start_ + block_width4x4 - 1) >>
       block_width4x4_log2;
+  // The superblock rows that reference the first superblock of a row the
+  // furthest to the right are the ones whose decoding may wait for it.
+  dependent_superblock_rows_ = 1;
+  if (frame_header_.allow_intrabc) {
+    while (dependent_superblock_rows_ * intra_block_copy_gradient_ -
+               intra_block_copy_offset_ <
+           superblock_columns_ - 1) {
+      ++dependent_superblock_rows_;
+    }
+  }
   // If |split_parse_and_decode_| is true, we do the necessary setup for
   // splitting the parsing and the decoding steps. This is done in the following
   // two cases:
   //  1) If there is multi-threading within a tile (this is done if
-  //     |thread_pool_| is not nullptr and if there are at least as many
-  //     superblock columns as |intra_block_copy_lag_|).
+  //     |thread_pool_| is not nullptr and if there is more than one superblock
+  //     column).
   //  2) If |frame_parallel| is true.
-  split_parse_and_decode_ = (thread_pool_ != nullptr &&
-                             superblock_columns_ > intra_block_copy_lag_) ||
-                            frame_parallel;
+  split_parse_and_decode_ =
+      (thread_pool_ != nullptr && superblock_columns_ > 1) || frame_parallel;
   if (frame_parallel_) {
     reference_frame_progress_cache_.fill(INT_MIN);
   }
@@ -569,6 +583,14 @@ bool Tile::Init() {
       return false;
     }
   }
+  // Add 32 * |kResidualPaddingVertical| padding to avoid bottom boundary checks
+  // when parsing quantized coefficients.
+  residual_buffer_ = MakeAlignedUniquePtr<uint8_t>(
+      32, (4096 + 32 * kResidualPaddingVertical) * residual_size_);
+  if (residual_buffer_ == nullptr) {
+    LIBGAV1_DLOG(ERROR, "Allocation of residual_buffer_ failed.");
+    return false;
+  }
   if (split_parse_and_decode_) {
     assert(residual_buffer_pool_ != nullptr);
     if (!residual_buffer_threaded_.Reset(superblock_rows_, superblock_columns_,
@@ -577,26 +599,14 @@ bool Tile::Init() {
       return false;
     }
   } else {
-    // Add 32 * |kResidualPaddingVertical| padding to avoid bottom boundary
-    // checks when parsing quantized coefficients.
-    residual_buffer_ = MakeAlignedUniquePtr<uint8_t>(
-        32, (4096 + 32 * kResidualPaddingVertical) * residual_size_);
-    if (residual_buffer_ == nullptr) {
-      LIBGAV1_DLOG(ERROR, "Allocation of residual_buffer_ failed.");
-      return false;
-    }
     prediction_parameters_.reset(new (std::nothrow) PredictionParameters());
     if (prediction_parameters_ == nullptr) {
       LIBGAV1_DLOG(ERROR, "Allocation of prediction_parameters_ failed.");
       return false;
     }
   }
-  if (frame_header_.use_ref_frame_mvs) {
-    assert(sequence_header_.enable_order_hint);
-    SetupMotionField(frame_header_, current_frame_, reference_frames_,
-                     row4x4_start_, row4x4_end_, column4x4_start_,
-                     column4x4_end_, &motion_field_);
-  }
+  assert(!frame_header_.use_ref_frame_mvs ||
+         sequence_header_.enable_order_hint);
   ResetLoopRestorationParams();
   return true;
 }
@@ -606,6 +616,9 @@ bool Tile::ProcessSuperBlockRow(int row4x4,
                                 TileScratchBuffer* const scratch_buffer) {
   if (row4x4 < row4x4_start_ || row4x4 >= row4x4_end_) return true;
   assert(scratch_buffer != nullptr);
+  if (processing_mode != kProcessingModeDecodeOnly) {
+    SetupMotionFieldForSuperBlockRow(row4x4);
+  }
   const int block_width4x4 = kNum4x4BlocksWide[SuperBlockSize()];
   for (int column4x4 = column4x4_start_; column4x4 < column4x4_end_;
        column4x4 += block_width4x4) {
@@ -641,6 +654,14 @@ void Tile::SaveSymbolDecoderContext() {
   }
 }
 
+void Tile::SetupMotionFieldForSuperBlockRow(int row4x4) {
+  if (!frame_header_.use_ref_frame_mvs) return;
+  const int block_width4x4 = kNum4x4BlocksWide[SuperBlockSize()];
+  SetupMotionField(frame_header_, current_frame_, reference_frames_, row4x4,
+                   std::min(row4x4 + block_width4x4, row4x4_end_),
+                   column4x4_start_, column4x4_end_, &motion_field_);
+}
+
 bool Tile::ParseAndDecode() {
   // If this is the main thread, we build the loop filter bit masks when parsing
   // so that it happens in the current thread. This ensures that the main thread
@@ -750,16 +771,15 @@ bool Tile::Decode(
 }
 
 bool Tile::ThreadedParseAndDecode() {
-  {
-    std::lock_guard<std::mutex> lock(threading_.mutex);
-    if (!threading_.sb_state.Reset(superblock_rows_, superblock_columns_)) {
-      pending_tiles_->Decrement(false);
-      LIBGAV1_DLOG(ERROR, "threading.sb_state.Reset() failed.");
-      return false;
-    }
-    // Account for the parsing job.
-    ++threading_.pending_jobs;
+  threading_.sb_row_state.reset(new (std::nothrow)
+                                    SuperBlockRowState[superblock_rows_]);
+  if (threading_.sb_row_state == nullptr) {
+    pending_tiles_->Decrement(false);
+    LIBGAV1_DLOG(ERROR, "Failed to allocate threading_.sb_row_state.");
+    return false;
   }
+  // Account for the parsing job.
+  ++threading_.pending_jobs;
 
   const int block_width4x4 = kNum4x4BlocksWide[SuperBlockSize()];
 
@@ -773,142 +793,140 @@ bool Tile::ThreadedParseAndDecode() {
   }
   for (int row4x4 = row4x4_start_, row_index = 0; row4x4 < row4x4_end_;
        row4x4 += block_width4x4, ++row_index) {
+    // The decoding of the previous superblock rows proceeds in the thread
+    // pool while this superblock row is being projected.
+    SetupMotionFieldForSuperBlockRow(row4x4);
     for (int column4x4 = column4x4_start_, column_index = 0;
          column4x4 < column4x4_end_;
          column4x4 += block_width4x4, ++column_index) {
       if (!ProcessSuperBlock(row4x4, column4x4, block_width4x4,
                              scratch_buffer.get(), kProcessingModeParseOnly)) {
-        std::lock_guard<std::mutex> lock(threading_.mutex);
         threading_.abort = true;
         break;
       }
-      std::unique_lock<std::mutex> lock(threading_.mutex);
       if (threading_.abort) break;
-      threading_.sb_state[row_index][column_index] = kSuperBlockStateParsed;
-      // Schedule the decoding of this superblock if it is allowed.
-      if (CanDecode(row_index, column_index)) {
-        ++threading_.pending_jobs;
-        threading_.sb_state[row_index][column_index] =
-            kSuperBlockStateScheduled;
-        lock.unlock();
-        thread_pool_->Schedule(
-            [this, row_index, column_index, block_width4x4]() {
-              DecodeSuperBlock(row_index, column_index, block_width4x4);
-            });
+      SuperBlockRowState& state = threading_.sb_row_state[row_index];
+      state.parsed_columns = column_index + 1;
+      // Schedule the decoding of this superblock row if it is allowed. Wait
+      // until a run of superblocks is ready (or the row is parsed completely)
+      // so that each job decodes several superblocks when the decoding is
+      // faster than the parsing.
+      if (column_index + 1 - state.decoded_columns >= kSuperBlockRunLength ||
+          column4x4 + block_width4x4 >= column4x4_end_) {
+        MaybeScheduleSuperBlockRow(row_index, block_width4x4);
       }
     }
-    std::lock_guard<std::mutex> lock(threading_.mutex);
     if (threading_.abort) break;
   }
   tile_scratch_buffer_pool_->Release(std::move(scratch_buffer));
 
   // We are done parsing. We can return here since the calling thread will make
   // sure that it waits for all the superblocks to be decoded.
-  //
-  // Finish using |threading_| before |pending_tiles_->Decrement()| because the
-  // Tile object could go out of scope as soon as |pending_tiles_->Decrement()|
-  // is called.
-  threading_.mutex.lock();
-  const bool no_pending_jobs = (--threading_.pending_jobs == 0);
   const bool job_succeeded = !threading_.abort;
-  threading_.mutex.unlock();
-  if (no_pending_jobs) {
-    // We are done parsing and decoding this tile.
-    pending_tiles_->Decrement(job_succeeded);
-  }
+  EndThreadedJob();
   return job_succeeded;
 }
 
-bool Tile::CanDecode(int row_index, int column_index) const {
+bool Tile::CanDecode(int row_index) const {
   assert(row_index >= 0);
-  assert(column_index >= 0);
-  // If |threading_.sb_state[row_index][column_index]| is not equal to
-  // kSuperBlockStateParsed, then return false. This is ok because if
-  // |threading_.sb_state[row_index][column_index]| is equal to:
-  //   kSuperBlockStateNone - then the superblock is not yet parsed.
-  //   kSuperBlockStateScheduled - then the superblock is already scheduled for
-  //                               decode.
-  //   kSuperBlockStateDecoded - then the superblock has already been decoded.
-  if (row_index >= superblock_rows_ || column_index >= superblock_columns_ ||
-      threading_.sb_state[row_index][column_index] != kSuperBlockStateParsed) {
+  if (row_index >= superblock_rows_) return false;
+  const SuperBlockRowState& state = threading_.sb_row_state[row_index];
+  const int column_index = state.decoded_columns;
+  // The superblock must have been parsed. This also rules out the rows that
+  // have been completely decoded.
+  if (column_index >= state.parsed_columns) return false;
+  // Superblocks in the first row only depend on the superblock to the left of
+  // it, which has been decoded since the columns are decoded in order.
+  if (row_index == 0) return true;
+  // All other superblocks also depend on the superblock to the top right.
+  const int top_right_column_index =
+      std::min(column_index + 1, superblock_columns_ - 1);
+  if (threading_.sb_row_state[row_index - 1].decoded_columns <=
+      top_right_column_index) {
     return false;
   }
-  // First superblock has no dependencies.
-  if (row_index == 0 && column_index == 0) {
-    return true;
-  }
-  // Superblocks in the first row only depend on the superblock to the left of
-  // it.
-  if (row_index == 0) {
-    return threading_.sb_state[0][column_index - 1] == kSuperBlockStateDecoded;
+  // With intra block copy, they may also reference the superblocks of the rows
+  // further up, as far to the right as the wavefront constraint allows. A row
+  // that has to be decoded completely implies that the rows above it are, so
+  // only |dependent_superblock_rows_| rows are checked.
+  const int rows = std::min(row_index, dependent_superblock_rows_);
+  for (int k = 2; k <= rows; ++k) {
+    const int last_column_index =
+        std::min(column_index + k * intra_block_copy_gradient_ -
+                     intra_block_copy_offset_,
+                 superblock_columns_ - 1);
+    if (threading_.sb_row_state[row_index - k].decoded_columns <=
+        last_column_index) {
+      return false;
+    }
   }
-  // All other superblocks depend on superblock to the left of it (if one
-  // exists) and superblock to the top right with a lag of
-  // |intra_block_copy_lag_| (if one exists).
-  const int top_right_column_index =
-      std::min(column_index + intra_block_copy_lag_, superblock_columns_ - 1);
-  return threading_.sb_state[row_index - 1][top_right_column_index] ==
-             kSuperBlockStateDecoded &&
-         (column_index == 0 ||
-          threading_.sb_state[row_index][column_index - 1] ==
-              kSuperBlockStateDecoded);
+  return true;
 }
 
-void Tile::DecodeSuperBlock(int row_index, int column_index,
-                            int block_width4x4) {
+void Tile::MaybeScheduleSuperBlockRow(int row_index, int block_width4x4) {
+  if (row_index >= superblock_rows_) return;
+  SuperBlockRowState& state = threading_.sb_row_state[row_index];
+  // Check |state.owned| first since it is the cheapest test and the row is
+  // usually owned while there is work for it.
+  if (state.owned || threading_.abort || !CanDecode(row_index)) return;
+  bool owned = false;
+  if (!state.owned.compare_exchange_strong(owned, true)) return;
+  ++threading_.pending_jobs;
+  thread_pool_->Schedule([this, row_index, block_width4x4]() {
+    DecodeSuperBlockRow(row_index, block_width4x4);
+  });
+}
+
+void Tile::DecodeSuperBlockRow(int row_index, int block_width4x4) {
+  SuperBlockRowState& state = threading_.sb_row_state[row_index];
   const int row4x4 = row4x4_start_ + (row_index * block_width4x4);
-  const int column4x4 = column4x4_start_ + (column_index * block_width4x4);
   std::unique_ptr<TileScratchBuffer> scratch_buffer =
       tile_scratch_buffer_pool_->Get();
-  bool ok = scratch_buffer != nullptr;
-  if (ok) {
-    ok = ProcessSuperBlock(row4x4, column4x4, block_width4x4,
-                           scratch_buffer.get(), kProcessingModeDecodeOnly);
-    tile_scratch_buffer_pool_->Release(std::move(scratch_buffer));
-  }
-  std::unique_lock<std::mutex> lock(threading_.mutex);
-  if (ok) {
-    threading_.sb_state[row_index][column_index] = kSuperBlockStateDecoded;
-    // Candidate rows and columns that we could potentially begin the decoding
-    // (if it is allowed to do so). The candidates are:
-    //   1) The superblock to the bottom-left of the current superblock with a
-    //   lag of |intra_block_copy_lag_| (or the beginning of the next superblock
-    //   row in case there are less than |intra_block_copy_lag_| superblock
-    //   columns in the Tile).
-    //   2) The superblock to the right of the current superblock.
-    const int candidate_row_indices[] = {row_index + 1, row_index};
-    const int candidate_column_indices[] = {
-        std::max(0, column_index - intra_block_copy_lag_), column_index + 1};
-    for (size_t i = 0; i < std::extent<decltype(candidate_row_indices)>::value;
-         ++i) {
-      const int candidate_row_index = candidate_row_indices[i];
-      const int candidate_column_index = candidate_column_indices[i];
-      if (!CanDecode(candidate_row_index, candidate_column_index)) {
-        continue;
+  if (scratch_buffer == nullptr) {
+    threading_.abort = true;
+    EndThreadedJob();
+    return;
+  }
+  while (true) {
+    // Decode the run of superblocks whose prerequisites are satisfied.
+    while (!threading_.abort && CanDecode(row_index)) {
+      const int column_index = state.decoded_columns;
+      const int column4x4 = column4x4_start_ + (column_index * block_width4x4);
+      if (!ProcessSuperBlock(row4x4, column4x4, block_width4x4,
+                             scratch_buffer.get(), kProcessingModeDecodeOnly)) {
+        threading_.abort = true;
+        break;
+      }
+      state.decoded_columns = column_index + 1;
+      // The superblocks below this superblock that depend on it may be
+      // decodable now.
+      for (int k = 1; k <= dependent_superblock_rows_; ++k) {
+        MaybeScheduleSuperBlockRow(row_index + k, block_width4x4);
       }
-      ++threading_.pending_jobs;
-      threading_.sb_state[candidate_row_index][candidate_column_index] =
-          kSuperBlockStateScheduled;
-      lock.unlock();
-      thread_pool_->Schedule([this, candidate_row_index, candidate_column_index,
-                              block_width4x4]() {
-        DecodeSuperBlock(candidate_row_index, candidate_column_index,
-                         block_width4x4);
-      });
-      lock.lock();
     }
-  } else {
-    threading_.abort = true;
+    if (threading_.abort) break;
+    // Give up the row. The parsing job or the job of the row above may have
+    // made progress after the last CanDecode() call while the row was still
+    // owned, in which case they did not schedule a new job. So check again
+    // after giving up the row and take it back if there is more work.
+    state.owned = false;
+    bool owned = false;
+    if (!CanDecode(row_index) ||
+        !state.owned.compare_exchange_strong(owned, true)) {
+      break;
+    }
   }
-  // Finish using |threading_| before |pending_tiles_->Decrement()| because the
-  // Tile object could go out of scope as soon as |pending_tiles_->Decrement()|
-  // is called.
-  const bool no_pending_jobs = (--threading_.pending_jobs == 0);
-  const bool job_succeeded = !threading_.abort;
-  lock.unlock();
-  if (no_pending_jobs) {
+  tile_scratch_buffer_pool_->Release(std::move(scratch_buffer));
+  EndThreadedJob();
+}
+
+void Tile::EndThreadedJob() {
+  // The Tile object could go out of scope as soon as
+  // |pending_tiles_->Decrement()| is called, so only the last job may use
+  // |threading_| after decrementing |threading_.pending_jobs|.
+  if (--threading_.pending_jobs == 0) {
     // We are done parsing and decoding this tile.
-    pending_tiles_->Decrement(job_succeeded);
+    pending_tiles_->Decrement(!threading_.abort);
   }
 }
 
@@ -1513,9 +1531,9 @@ int Tile::ReadTransformCoefficients(const Block& block, Plane plane,
        *tx_type < kTransformTypeIdentityIdentity &&
        !frame_header_.segmentation.lossless[bp.segment_id] &&
        frame_header_.quantizer.matrix_level[plane] < 15)
-          ? quantizer_matrix_[frame_header_.quantizer.matrix_level[plane]]
-                             [plane_type][adjusted_tx_size]
-                                 .get()
+          ? (*quantizer_matrix_)[frame_header_.quantizer.matrix_level[plane]]
+                                [plane_type][adjusted_tx_size]
+                                    .get()
           : nullptr;
   int coefficient_level = 0;
   int8_t dc_category = 0;
@@ -1545,7 +1563,23 @@ int Tile::ReadTransformCoefficients(const Block& block, Plane plane,
   SetEntropyContexts(x4, y4, w4, h4, plane, std::min(4, coefficient_level),
                      dc_category);
   if (split_parse_and_decode_) {
-    *block.residual += tx_width * tx_height * residual_size_;
+    // Only the coefficients up to the last position that can be non-zero are
+    // stored for the decode step.
+    int max_position = 0;
+    for (int i = 0; i < eob; ++i) {
+      max_position = std::max(max_position, static_cast<int>(scan[i]));
+    }
+    // MoveCoefficientsForTxWidth64() has moved the coefficient at position
+    // (row * 32 + column) to (row * 64 + column).
+    const int count = (tx_width == 64)
+                          ? ((max_position >> 5) << 6) + (max_position & 31) + 1
+                          : max_position + 1;
+    if (!residual_buffer_threaded_[SuperBlockRowIndex(block.row4x4)]
+                                  [SuperBlockColumnIndex(block.column4x4)]
+                                      ->Pack(residual, count)) {
+      LIBGAV1_DLOG(ERROR, "Failed to store the residual values.");
+      return -1;
+    }
   }
   return eob;
 }
@@ -1629,9 +1663,23 @@ bool Tile::TransformBlock(const Block& block, Plane plane, int base_x,
     const int sb_row_index = SuperBlockRowIndex(block.row4x4);
     const int sb_column_index = SuperBlockColumnIndex(block.column4x4);
     if (mode == kProcessingModeDecodeOnly) {
+      ResidualBuffer* const residual_buffer =
+          residual_buffer_threaded_[sb_row_index][sb_column_index].get();
       TransformParameterQueue& tx_params =
-          *residual_buffer_threaded_[sb_row_index][sb_column_index]
-               ->transform_parameters();
+          *residual_buffer->transform_parameters();
+      if (tx_params.NonZeroCoeffCount() > 0) {
+        const int size = kTransformWidth[tx_size] * kTransformHeight[tx_size];
+#if LIBGAV1_MAX_BITDEPTH >= 10
+        if (sequence_header_.color_config.bitdepth > 8) {
+          residual_buffer->Unpack(size,
+                                  reinterpret_cast<int32_t*>(*block.residual));
+        } else  // NOLINT
+#endif
+        {
+          residual_buffer->Unpack(size,
+                                  reinterpret_cast<int16_t*>(*block.residual));
+        }
+      }
       ReconstructBlock(block, plane, start_x, start_y, tx_size,
                        tx_params.Type(), tx_params.NonZeroCoeffCount());
       tx_params.Pop();
@@ -1734,27 +1782,34 @@ void Tile::ReconstructBlock(const Block& block, Plane plane, int start_x,
   // Reconstruction process. Steps 2 and 3 of Section 7.12.3 in the spec.
   assert(non_zero_coeff_count >= 0);
   if (non_zero_coeff_count == 0) return;
+  const bool lossless =
+      frame_header_.segmentation.lossless[block.bp->segment_id];
+  const bool keep_low_frequency = preview_scale_log2_ != 0 && !lossless;
 #if LIBGAV1_MAX_BITDEPTH >= 10
   if (sequence_header_.color_config.bitdepth > 8) {
     Array2DView<uint16_t> buffer(
         buffer_[plane].rows(), buffer_[plane].columns() / sizeof(uint16_t),
         reinterpret_cast<uint16_t*>(&buffer_[plane][0][0]));
-    Reconstruct(dsp_, tx_type, tx_size,
-                frame_header_.segmentation.lossless[block.bp->segment_id],
-                reinterpret_cast<int32_t*>(*block.residual), start_x, start_y,
+    auto* const residual = reinterpret_cast<int32_t*>(*block.residual);
+    if (keep_low_frequency) {
+      non_zero_coeff_count = KeepLowFrequencyCoefficients(
+          tx_type, tx_size, preview_scale_log2_, residual,
+          non_zero_coeff_count);
+    }
+    Reconstruct(dsp_, tx_type, tx_size, lossless, residual, start_x, start_y,
                 &buffer, non_zero_coeff_count);
   } else  // NOLINT
 #endif
   {
-    Reconstruct(dsp_, tx_type, tx_size,
-                frame_header_.segmentation.lossless[block.bp->segment_id],
-                reinterpret_cast<int16_t*>(*block.residual), start_x, start_y,
+    auto* const residual = reinterpret_cast<int16_t*>(*block.residual);
+    if (keep_low_frequency) {
+      non_zero_coeff_count = KeepLowFrequencyCoefficients(
+          tx_type, tx_size, preview_scale_log2_, residual,
+          non_zero_coeff_count);
+    }
+    Reconstruct(dsp_, tx_type, tx_size, lossless, residual, start_x, start_y,
                 &buffer_[plane], non_zero_coeff_count);
   }
-  if (split_parse_and_decode_) {
-    *block.residual +=
-        kTransformWidth[tx_size] * kTransformHeight[tx_size] * residual_size_;
-  }
 }
 
 bool Tile::Residual(const Block& block, ProcessingMode mode) {
@@ -2153,6 +2208,10 @@ bool Tile::ProcessBlock(int row4x4, int column4x4, BlockSize block_size,
   bp.uv_transform_size = frame_header_.segmentation.lossless[bp.segment_id]
                              ? kTransformSize4x4
                              : kUVTransformSize[block.residual_size[kPlaneU]];
+  block_parameters_holder_.FillPackedCache(row4x4, column4x4, block_size, bp,
+                                           post_filter_.DoDeblock());
+  post_filter_.StoreDeblockFilterEdges(row4x4, column4x4, block_size,
+                                       row4x4_start_, column4x4_start_);
   if (bp.skip) ResetEntropyContext(block);
   if (split_parse_and_decode_) {
     if (!Residual(block, kProcessingModeParseOnly)) return false;
@@ -2410,8 +2469,7 @@ bool Tile::ProcessSuperBlock(int row4x4, int column4x4, int block_width4x4,
       LIBGAV1_DLOG(ERROR, "Failed to get residual buffer.");
       return false;
     }
-    uint8_t* residual_buffer =
-        residual_buffer_threaded_[sb_row_index][sb_column_index]->buffer();
+    uint8_t* residual_buffer = residual_buffer_.get();
     if (!ProcessPartition(row4x4, column4x4,
                           block_parameters_holder_.Tree(row, column),
                           scratch_buffer, &residual_buffer)) {
@@ -2420,8 +2478,7 @@ bool Tile::ProcessSuperBlock(int row4x4, int column4x4, int block_width4x4,
       return false;
     }
   } else {
-    uint8_t* residual_buffer =
-        residual_buffer_threaded_[sb_row_index][sb_column_index]->buffer();
+    uint8_t* residual_buffer = scratch_buffer->residual;
     if (!DecodeSuperBlock(block_parameters_holder_.Tree(row, column),
                           scratch_buffer, &residual_buffer)) {
       LIBGAV1_DLOG(ERROR, "Error decoding superblock row: %d column: %d",
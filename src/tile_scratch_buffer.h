@@ -89,6 +89,16 @@ struct TileScratchBuffer : public MaxAlignedAllocable {
     int16_t cfl_luma_buffer[kCflLumaBufferStride][kCflLumaBufferStride];
   };
 
+  // Buffer used to hold the residual values of one transform block in the
+  // "decode" step when parsing and decoding are done separately. They are
+  // unpacked from the ResidualBuffer of the superblock. It is accessed either
+  // as an int16_t or int32_t depending on |bitdepth|.
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  alignas(kMaxAlignment) uint8_t residual[64 * 64 * sizeof(int32_t)];
+#else
+  alignas(kMaxAlignment) uint8_t residual[64 * 64 * sizeof(int16_t)];
+#endif
+
   // Buffer used for convolve. The maximum size required for this buffer is:
   //  maximum block height (with scaling and border) = 2 * 128 + 3 + 4 = 263.
   //  maximum block stride (with scaling and border aligned to 16) =
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 
+#include "src/utils/bit_mask_set.h"
 #include "src/utils/common.h"
 #include "src/utils/constants.h"
 #include "src/utils/logging.h"
@@ -33,6 +34,30 @@ int RowsOrColumns4x4ToSuperBlocks(int value4x4, bool use_128x128_superblock) {
                                 : DivideBy64(MultiplyBy4(value4x4) + 63);
 }
 
+constexpr BitMaskSet kPredictionModeNewMvMask(kPredictionModeNewMv,
+                                              kPredictionModeNewNewMv,
+                                              kPredictionModeNearNewMv,
+                                              kPredictionModeNewNearMv,
+                                              kPredictionModeNearestNewMv,
+                                              kPredictionModeNewNearestMv);
+
+// Fills |rows| x |columns| entries of |plane| starting at |offset| with
+// |value|.
+template <typename T>
+void FillPlane(Array2D<T>* const plane, ptrdiff_t offset, int rows, int columns,
+               ptrdiff_t stride, T value) {
+  T* dst = plane->data() + offset;
+  do {
+    // The following loop has better performance than using std::fill().
+    int x = columns;
+    T* d = dst;
+    do {
+      *d++ = value;
+    } while (--x != 0);
+    dst += stride;
+  } while (--rows != 0);
+}
+
 }  // namespace
 
 bool BlockParametersHolder::Reset(int rows4x4, int columns4x4,
@@ -44,6 +69,23 @@ bool BlockParametersHolder::Reset(int rows4x4, int columns4x4,
     LIBGAV1_DLOG(ERROR, "block_parameters_cache_.Reset() failed.");
     return false;
   }
+  // The packed planes are always written by FillPackedCache() before they are
+  // read, so they need not be initialized.
+  bool ok = sizes_.Reset(rows4x4_, columns4x4_, /*zero_initialize=*/false) &&
+            flags_.Reset(rows4x4_, columns4x4_, /*zero_initialize=*/false) &&
+            mvs_.Reset(rows4x4_, columns4x4_, /*zero_initialize=*/false) &&
+            uv_transform_sizes_.Reset(rows4x4_, columns4x4_,
+                                      /*zero_initialize=*/false);
+  for (auto& plane : reference_frames_) {
+    ok = ok && plane.Reset(rows4x4_, columns4x4_, /*zero_initialize=*/false);
+  }
+  for (auto& plane : deblock_filter_levels_) {
+    ok = ok && plane.Reset(rows4x4_, columns4x4_, /*zero_initialize=*/false);
+  }
+  if (!ok) {
+    LIBGAV1_DLOG(ERROR, "Allocation of the packed block parameters failed.");
+    return false;
+  }
   const int rows =
       RowsOrColumns4x4ToSuperBlocks(rows4x4_, use_128x128_superblock_);
   const int columns =
@@ -104,4 +146,38 @@ void BlockParametersHolder::FillCache(int row4x4, int column4x4,
   }
 }
 
+void BlockParametersHolder::FillPackedCache(int row4x4, int column4x4,
+                                            BlockSize block_size,
+                                            const BlockParameters& bp,
+                                            bool fill_deblock_parameters) {
+  const int rows = std::min(static_cast<int>(kNum4x4BlocksHigh[block_size]),
+                            rows4x4_ - row4x4);
+  const int columns = std::min(
+      static_cast<int>(kNum4x4BlocksWide[block_size]), columns4x4_ - column4x4);
+  const ptrdiff_t offset = Offset(row4x4, column4x4);
+  uint8_t flags = 0;
+  if (bp.is_inter) {
+    flags |= kBlockParametersFlagIsInter;
+    if (bp.skip) flags |= kBlockParametersFlagSkipInter;
+  }
+  if (bp.is_global_mv_block) flags |= kBlockParametersFlagIsGlobalMvBlock;
+  if (kPredictionModeNewMvMask.Contains(bp.y_mode)) {
+    flags |= kBlockParametersFlagHasNewMv;
+  }
+  FillPlane(&sizes_, offset, rows, columns, columns4x4_, block_size);
+  FillPlane(&flags_, offset, rows, columns, columns4x4_, flags);
+  FillPlane(&reference_frames_[0], offset, rows, columns, columns4x4_,
+            bp.reference_frame[0]);
+  FillPlane(&reference_frames_[1], offset, rows, columns, columns4x4_,
+            bp.reference_frame[1]);
+  FillPlane(&mvs_, offset, rows, columns, columns4x4_, bp.mv);
+  if (!fill_deblock_parameters) return;
+  for (int i = 0; i < kFrameLfCount; ++i) {
+    FillPlane(&deblock_filter_levels_[i], offset, rows, columns, columns4x4_,
+              bp.deblock_filter_level[i]);
+  }
+  FillPlane(&uv_transform_sizes_, offset, rows, columns, columns4x4_,
+            bp.uv_transform_size);
+}
+
 }  // namespace libgav1
@@ -17,6 +17,8 @@
 #ifndef LIBGAV1_SRC_UTILS_BLOCK_PARAMETERS_HOLDER_H_
 #define LIBGAV1_SRC_UTILS_BLOCK_PARAMETERS_HOLDER_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
 #include "src/utils/array_2d.h"
@@ -27,6 +29,16 @@
 
 namespace libgav1 {
 
+// Bits of the packed per 4x4 flags plane of BlockParametersHolder.
+enum BlockParametersFlag : uint8_t {
+  kBlockParametersFlagIsInter = 1,
+  kBlockParametersFlagIsGlobalMvBlock = 2,
+  // The y_mode of the block is one of the modes that read a new motion vector.
+  kBlockParametersFlagHasNewMv = 4,
+  // Both skip and is_inter are true for the block.
+  kBlockParametersFlagSkipInter = 8
+};
+
 // Holds a 2D array of |ParameterTree| objects. Each tree stores the parameters
 // corresponding to a superblock.
 class BlockParametersHolder {
@@ -59,6 +71,31 @@ class BlockParametersHolder {
 
   int columns4x4() const { return columns4x4_; }
 
+  // Returns the offset of (|row4x4|, |column4x4|) in the cache matrix and in
+  // the packed planes below.
+  ptrdiff_t Offset(int row4x4, int column4x4) const {
+    return row4x4 * columns4x4_ + column4x4;
+  }
+
+  // Packed per 4x4 planes of the BlockParameters fields that the motion vector
+  // search and the deblocking filter read. They have the same layout as the
+  // cache matrix, so the neighbor lookups read small contiguous values instead
+  // of following a pointer per 4x4 block. The entries of a block are valid
+  // once FillPackedCache() has been called for it.
+  const BlockSize* sizes() const { return sizes_.data(); }
+  const uint8_t* flags() const { return flags_.data(); }
+  const ReferenceFrameType* reference_frames(int index) const {
+    return reference_frames_[index].data();
+  }
+  const CompoundMotionVector* mvs() const { return mvs_.data(); }
+  // Only valid if the deblocking filter is enabled for the frame.
+  const uint8_t* deblock_filter_levels(int index) const {
+    return deblock_filter_levels_[index].data();
+  }
+  const TransformSize* uv_transform_sizes() const {
+    return uv_transform_sizes_.data();
+  }
+
   // Returns the ParameterTree corresponding to superblock starting at (|row|,
   // |column|).
   ParameterTree* Tree(int row, int column) { return trees_[row][column].get(); }
@@ -68,6 +105,13 @@ class BlockParametersHolder {
   void FillCache(int row4x4, int column4x4, BlockSize block_size,
                  BlockParameters* bp);
 
+  // Fills the packed planes for the block starting at |row4x4|, |column4x4| of
+  // size |block_size| from |bp|. This has to be called after the mode info and
+  // the transform size of the block have been decoded. The deblock planes are
+  // filled only if |fill_deblock_parameters| is true.
+  void FillPackedCache(int row4x4, int column4x4, BlockSize block_size,
+                       const BlockParameters& bp, bool fill_deblock_parameters);
+
  private:
   int rows4x4_ = 0;
   int columns4x4_ = 0;
@@ -78,6 +122,14 @@ class BlockParametersHolder {
   // FillCache() and used by Find() to perform look ups using exactly one look
   // up (instead of traversing the entire tree).
   Array2D<BlockParameters*> block_parameters_cache_;
+
+  Array2D<BlockSize> sizes_;
+  // A combination of BlockParametersFlag bits.
+  Array2D<uint8_t> flags_;
+  Array2D<ReferenceFrameType> reference_frames_[2];
+  Array2D<CompoundMotionVector> mvs_;
+  Array2D<uint8_t> deblock_filter_levels_[kFrameLfCount];
+  Array2D<TransformSize> uv_transform_sizes_;
 };
 
 }  // namespace libgav1
@@ -471,30 +471,6 @@ constexpr int GetDeblockPosition(const int luma_position,
   return luma_position | subsampling;
 }
 
-// Returns the size of the residual buffer required to hold the residual values
-// for a block or frame of size |rows| by |columns| (taking into account
-// |subsampling_x|, |subsampling_y| and |residual_size|). |residual_size| is the
-// number of bytes required to represent one residual value.
-inline size_t GetResidualBufferSize(const int rows, const int columns,
-                                    const int subsampling_x,
-                                    const int subsampling_y,
-                                    const size_t residual_size) {
-  // The subsampling multipliers are:
-  //   Both x and y are subsampled: 3 / 2.
-  //   Only x or y is subsampled: 2 / 1 (which is equivalent to 4 / 2).
-  //   Both x and y are not subsampled: 3 / 1 (which is equivalent to 6 / 2).
-  // So we compute the final subsampling multiplier as follows:
-  //   multiplier = (2 + (4 >> subsampling_x >> subsampling_y)) / 2.
-  // Add 32 * |kResidualPaddingVertical| padding to avoid bottom boundary checks
-  // when parsing quantized coefficients.
-  const int subsampling_multiplier_num =
-      2 + (4 >> subsampling_x >> subsampling_y);
-  const int number_elements =
-      (rows * columns * subsampling_multiplier_num) >> 1;
-  const int tx_padding = 32 * kResidualPaddingVertical;
-  return residual_size * (number_elements + tx_padding);
-}
-
 // This function is equivalent to:
 // std::min({kTransformWidthLog2[tx_size] - 2,
 //           kTransformWidthLog2[left_tx_size] - 2,
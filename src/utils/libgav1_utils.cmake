@@ -39,6 +39,8 @@ list(APPEND libgav1_utils_sources
             "${libgav1_source}/utils/logging.cc"
             "${libgav1_source}/utils/logging.h"
             "${libgav1_source}/utils/memory.h"
+            "${libgav1_source}/utils/numa.cc"
+            "${libgav1_source}/utils/numa.h"
             "${libgav1_source}/utils/parameter_tree.cc"
             "${libgav1_source}/utils/parameter_tree.h"
             "${libgav1_source}/utils/queue.h"
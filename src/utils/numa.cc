@@ -0,0 +1,82 @@
+// Copyright 2020 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/utils/numa.h"
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+#include "src/utils/logging.h"
+
+namespace libgav1 {
+
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_get_mempolicy)
+
+namespace {
+
+// The values from <numaif.h>, which is not available without libnuma.
+constexpr int kMpolInterleave = 3;
+constexpr unsigned long kMpolFMemsAllowed = 1 << 2;  // NOLINT(runtime/int)
+
+// Large enough for the maximum number of NUMA nodes supported by Linux.
+constexpr int kMaxNumaNodes = 1024;
+constexpr int kBitsPerWord = 8 * sizeof(unsigned long);  // NOLINT(runtime/int)
+
+}  // namespace
+
+bool InterleaveAcrossNumaNodes(void* const data, size_t size) {
+  unsigned long node_mask[kMaxNumaNodes / kBitsPerWord];  // NOLINT(runtime/int)
+  memset(node_mask, 0, sizeof(node_mask));
+  if (syscall(SYS_get_mempolicy, nullptr, node_mask, kMaxNumaNodes, nullptr,
+              kMpolFMemsAllowed) != 0) {
+    LIBGAV1_DLOG(ERROR, "get_mempolicy() failed.");
+    return false;
+  }
+  int num_nodes = 0;
+  for (const unsigned long word : node_mask) {  // NOLINT(runtime/int)
+    num_nodes += __builtin_popcountl(word);
+  }
+  if (num_nodes <= 1) return true;
+
+  const long page_size = sysconf(_SC_PAGESIZE);  // NOLINT(runtime/int)
+  if (page_size <= 0) return false;
+  const auto page_mask = static_cast<uintptr_t>(page_size - 1);
+  const auto begin =
+      (reinterpret_cast<uintptr_t>(data) + page_mask) & ~page_mask;
+  const auto end = (reinterpret_cast<uintptr_t>(data) + size) & ~page_mask;
+  if (end <= begin) return true;
+  if (syscall(SYS_mbind, begin, end - begin, kMpolInterleave, node_mask,
+              kMaxNumaNodes, 0) != 0) {
+    LIBGAV1_DLOG(ERROR, "mbind() failed.");
+    return false;
+  }
+  return true;
+}
+
+#else  // !(defined(__linux__) && defined(SYS_mbind) &&
+       //   defined(SYS_get_mempolicy))
+
+bool InterleaveAcrossNumaNodes(void* /*data*/, size_t /*size*/) {
+  return false;
+}
+
+#endif  // defined(__linux__) && defined(SYS_mbind) &&
+        // defined(SYS_get_mempolicy)
+
+}  // namespace libgav1
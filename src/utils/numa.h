@@ -0,0 +1,37 @@
+/*
+ * Copyright 2020 The libgav1 Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBGAV1_SRC_UTILS_NUMA_H_
+#define LIBGAV1_SRC_UTILS_NUMA_H_
+
+#include <cstddef>
+
+namespace libgav1 {
+
+// Asks the operating system to interleave the pages of [data, data + size)
+// across all the NUMA nodes that the process may allocate memory from. Only
+// the pages that lie entirely inside the range and have not been touched yet
+// are affected, so the range should be a private anonymous mapping that has
+// just been created. It must not be used on memory returned by malloc(),
+// since the policy would also apply to the other allocations that share its
+// pages. Returns true if the policy was applied or if there is nothing
+// to do (a single NUMA node, or a range smaller than a page). Returns false if
+// it is not supported or fails; the memory is still usable in that case.
+bool InterleaveAcrossNumaNodes(void* data, size_t size);
+
+}  // namespace libgav1
+
+#endif  // LIBGAV1_SRC_UTILS_NUMA_H_
@@ -82,6 +82,18 @@ std::unique_ptr<ThreadPool> ThreadPool::Create(const char name_prefix[],
   return pool;
 }
 
+// static
+std::unique_ptr<ThreadPool> ThreadPool::Create(
+    ScheduleJobFunction schedule_job, void* private_data, int num_threads) {
+  if (schedule_job == nullptr || num_threads <= 0) return nullptr;
+  std::unique_ptr<ThreadPool> pool(new (std::nothrow) ThreadPool(
+      schedule_job, private_data, num_threads));
+  if (pool != nullptr && !pool->StartWorkers()) {
+    pool = nullptr;
+  }
+  return pool;
+}
+
 ThreadPool::ThreadPool(const char name_prefix[],
                        std::unique_ptr<WorkerThread*[]> threads,
                        int num_threads)
@@ -94,6 +106,14 @@ ThreadPool::ThreadPool(const char name_prefix[],
   name_prefix_[name_prefix_len] = '\0';
 }
 
+ThreadPool::ThreadPool(ScheduleJobFunction schedule_job, void* private_data,
+                       int num_threads)
+    : num_threads_(num_threads),
+      schedule_job_(schedule_job),
+      schedule_job_private_data_(private_data) {
+  name_prefix_[0] = '\0';
+}
+
 ThreadPool::~ThreadPool() { Shutdown(); }
 
 void ThreadPool::Schedule(std::function<void()> closure) {
@@ -105,10 +125,47 @@ void ThreadPool::Schedule(std::function<void()> closure) {
     return;
   }
   queue_.Push(std::move(closure));
+  if (schedule_job_ != nullptr) {
+    ++pending_scheduled_jobs_;
+    UnlockMutex();
+    schedule_job_(schedule_job_private_data_, RunScheduledJob, this);
+    return;
+  }
   UnlockMutex();
   SignalOne();
 }
 
+// static
+void ThreadPool::RunScheduledJob(void* const pool) {
+  auto* const thread_pool = static_cast<ThreadPool*>(pool);
+  // The closure may already have been taken by TakePendingClosure() or by an
+  // earlier job, in which case there is nothing left to do.
+  std::function<void()> closure;
+  if (thread_pool->TakePendingClosure(&closure)) {
+    std::move(closure)();
+    closure = nullptr;
+  }
+  thread_pool->LockMutex();
+  const bool signal = --thread_pool->pending_scheduled_jobs_ == 0 &&
+                      thread_pool->exit_threads_;
+  // Signal while holding the mutex since the pool may be destroyed as soon as
+  // the mutex is released.
+  if (signal) thread_pool->SignalAll();
+  thread_pool->UnlockMutex();
+}
+
+bool ThreadPool::TakePendingClosure(std::function<void()>* const closure) {
+  LockMutex();
+  if (queue_.Empty()) {
+    UnlockMutex();
+    return false;
+  }
+  *closure = std::move(queue_.Front());
+  queue_.Pop();
+  UnlockMutex();
+  return true;
+}
+
 int ThreadPool::num_threads() const { return num_threads_; }
 
 // A simple implementation that mirrors the non-portable Thread.  We may
@@ -236,6 +293,7 @@ void ThreadPool::WorkerThread::Run() {
 
 bool ThreadPool::StartWorkers() {
   if (!queue_.Init()) return false;
+  if (schedule_job_ != nullptr) return true;
   for (int i = 0; i < num_threads_; ++i) {
     threads_[i] = new (std::nothrow) WorkerThread(this);
     if (threads_[i] == nullptr) return false;
@@ -309,6 +367,13 @@ void ThreadPool::Shutdown() {
   // Tell worker threads how to exit.
   LockMutex();
   exit_threads_ = true;
+  if (schedule_job_ != nullptr) {
+    // Every queued closure has a scheduled job that runs it, so it is enough
+    // to wait for the scheduled jobs.
+    while (pending_scheduled_jobs_ != 0) Wait();
+    UnlockMutex();
+    return;
+  }
   UnlockMutex();
   SignalAll();
 
@@ -68,6 +68,13 @@ namespace libgav1 {
 //   } // ThreadPool gets destroyed only when all jobs are done.
 class ThreadPool : public Executor, public Allocable {
  public:
+  // Asks the owner of some other threads to call |run_job|(|job_data|) exactly
+  // once on one of those threads. |private_data| is the value passed to
+  // Create().
+  using ScheduleJobFunction = void (*)(void* private_data,
+                                       void (*run_job)(void* job_data),
+                                       void* job_data);
+
   // Creates the thread pool with the specified number of worker threads.
   // If num_threads is 1, the closures are run in FIFO order.
   static std::unique_ptr<ThreadPool> Create(int num_threads);
@@ -76,6 +83,15 @@ class ThreadPool : public Executor, public Allocable {
   static std::unique_ptr<ThreadPool> Create(const char name_prefix[],
                                             int num_threads);
 
+  // Creates a thread pool that does not create any threads. Each closure
+  // passed to Schedule() is queued and |schedule_job| is called to run one
+  // queued closure on a thread that is not owned by the pool. |num_threads| is
+  // the number of closures that may be expected to run concurrently. The
+  // destructor waits until all the jobs passed to |schedule_job| have run.
+  static std::unique_ptr<ThreadPool> Create(ScheduleJobFunction schedule_job,
+                                            void* private_data,
+                                            int num_threads);
+
   // The destructor will shut down the thread pool and all jobs are executed.
   // Note that after shutdown, the thread pool does not accept further jobs.
   ~ThreadPool() override;
@@ -92,6 +108,13 @@ class ThreadPool : public Executor, public Allocable {
   //   2. Have the current thread wait until the queue is not full.
   void Schedule(std::function<void()> closure) override;
 
+  // If there is a queued closure that no worker thread has picked up yet,
+  // removes it from the queue, stores it in |*closure| and returns true.
+  // Otherwise returns false. The caller must run the closure. This allows a
+  // thread that would otherwise block on the work in this pool to do some of
+  // that work itself.
+  bool TakePendingClosure(std::function<void()>* closure);
+
   int num_threads() const;
 
  private:
@@ -102,6 +125,14 @@ class ThreadPool : public Executor, public Allocable {
   ThreadPool(const char name_prefix[], std::unique_ptr<WorkerThread*[]> threads,
              int num_threads);
 
+  // Creates the thread pool that runs the closures using |schedule_job|.
+  ThreadPool(ScheduleJobFunction schedule_job, void* private_data,
+             int num_threads);
+
+  // The function passed to |schedule_job_|. Runs one queued closure, if there
+  // is one left.
+  static void RunScheduledJob(void* pool);
+
   // Starts the worker pool.
   LIBGAV1_MUST_USE_RESULT bool StartWorkers();
 
@@ -154,6 +185,12 @@ class ThreadPool : public Executor, public Allocable {
 
   bool exit_threads_ LIBGAV1_GUARDED_BY(queue_mutex_) = false;
   const int num_threads_ = 0;
+  // If not nullptr, the closures are run using |schedule_job_| and |threads_|
+  // is nullptr.
+  const ScheduleJobFunction schedule_job_ = nullptr;
+  void* const schedule_job_private_data_ = nullptr;
+  // Number of calls to |schedule_job_| whose job has not finished yet.
+  int pending_scheduled_jobs_ LIBGAV1_GUARDED_BY(queue_mutex_) = 0;
   // name_prefix_ is a C string, whose length is restricted to 16 characters,
   // including the terminating null byte ('\0'). This restriction comes from
   // the Linux pthread_setname_np() function.